@@ -0,0 +1,467 @@
+#include "corpus_generator.h"
+#include "lexer/lexical.h"
+#include "lexer/lexical_exception.h"
+#include "lexer/output_buffer.h"
+#include "lexer/source_buffer.h"
+#include "lexer/token_serialize.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 全局 operator new 的调用次数，用于统计每个Token的内存分配次数
+std::atomic<uint64_t> allocation_count{0};
+
+void* allocate(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+
+using namespace dreamlang;
+using Clock = std::chrono::steady_clock;
+
+/**
+ * 基准测试选项
+ */
+struct BenchOptions {
+    uint64_t size = 16 * 1024 * 1024;
+    std::string mix_name = "mixed";
+    bench::CorpusMix mix;
+    uint64_t seed = 1;
+    unsigned repeat = 3;
+    // 不为空时只把语料写入这个文件
+    std::string write_path;
+    // 不为空时只运行名称包含该子串的测试
+    std::string filter;
+};
+
+/**
+ * 一项测试的结果
+ */
+struct Measurement {
+    // 多次运行中最快一次的耗时
+    double seconds = std::numeric_limits<double>::max();
+    // 一次运行中的内存分配次数
+    uint64_t allocations = 0;
+    // 序列化输出的字节数
+    uint64_t output_bytes = 0;
+};
+
+/**
+ * 只统计字节数、丢弃内容的流缓冲区，使序列化测试不受磁盘和内存增长的影响
+ */
+class CountingStreamBuffer : public std::streambuf {
+public:
+    uint64_t bytes = 0;
+
+protected:
+    int overflow(int c) override {
+        ++bytes;
+        return c;
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count) override {
+        bytes += static_cast<uint64_t>(count);
+        return count;
+    }
+};
+
+void printUsage() {
+    std::cout << "Usage: dreamlang_bench [options]\n"
+              << "\n"
+              << "Generates a deterministic .zv corpus and measures the lexer on it.\n"
+              << "\n"
+              << "Options:\n"
+              << "  --size N[K|M|G]     corpus size in bytes (default 16M, up to 1G)\n"
+              << "  --mix NAME          mixed, identifiers, comments, strings, numbers or nested\n"
+              << "  --weights I,C,S,N,D custom weights of identifiers, comments, strings, numbers and nesting\n"
+              << "  --seed N            random seed (default 1)\n"
+              << "  --repeat N          runs per benchmark, the fastest is reported (default 3)\n"
+              << "  --filter TEXT       only run benchmarks whose name contains TEXT\n"
+              << "  --write FILE        write the corpus to FILE and exit\n"
+              << "  -h, --help          show this help\n";
+}
+
+/**
+ * 解析带 K、M、G 后缀（按 1024 进位）的大小
+ */
+bool parseSize(const std::string& text, uint64_t& size) {
+    char* end = nullptr;
+    unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str()) {
+        return false;
+    }
+    std::string suffix(end);
+    if (suffix == "K" || suffix == "k") {
+        value <<= 10;
+    } else if (suffix == "M" || suffix == "m") {
+        value <<= 20;
+    } else if (suffix == "G" || suffix == "g") {
+        value <<= 30;
+    } else if (!suffix.empty()) {
+        return false;
+    }
+    size = value;
+    return true;
+}
+
+bool parseWeights(const std::string& text, bench::CorpusMix& mix) {
+    unsigned* weights[] = {&mix.identifiers, &mix.comments, &mix.strings, &mix.numbers, &mix.nesting};
+    std::istringstream fields(text);
+    std::string field;
+    size_t index = 0;
+    while (std::getline(fields, field, ',')) {
+        if (index == std::size(weights) || field.empty() ||
+            field.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        *weights[index++] = static_cast<unsigned>(std::stoul(field));
+    }
+    return index == std::size(weights) &&
+           mix.identifiers + mix.comments + mix.strings + mix.numbers + mix.nesting > 0;
+}
+
+/**
+ * 解析命令行，出错时输出原因
+ * @return 是否继续运行
+ */
+bool parseArguments(int argc, char* argv[], BenchOptions& options, int& status) {
+    status = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return false;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "dreamlang_bench: unknown option or missing value: " << arg << "\n";
+            status = 1;
+            return false;
+        }
+        std::string value = argv[++i];
+        bool valid = true;
+        if (arg == "--size") {
+            valid = parseSize(value, options.size);
+        } else if (arg == "--mix") {
+            auto mix = bench::findCorpusMix(value);
+            valid = mix.has_value();
+            if (valid) {
+                options.mix = *mix;
+                options.mix_name = value;
+            }
+        } else if (arg == "--weights") {
+            valid = parseWeights(value, options.mix);
+            options.mix_name = value;
+        } else if (arg == "--seed") {
+            valid = parseSize(value, options.seed);
+        } else if (arg == "--repeat") {
+            uint64_t repeat = 0;
+            valid = parseSize(value, repeat) && repeat > 0 && repeat <= 1000;
+            options.repeat = static_cast<unsigned>(repeat);
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else if (arg == "--write") {
+            options.write_path = value;
+        } else {
+            std::cerr << "dreamlang_bench: unknown option: " << arg << "\n";
+            status = 1;
+            return false;
+        }
+        if (!valid) {
+            std::cerr << "dreamlang_bench: invalid value for " << arg << ": " << value << "\n";
+            status = 1;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * 运行一项测试 repeat 次，记录最快一次的耗时和最后一次的分配次数
+ * @param run 测试本身，返回序列化输出的字节数（其他测试返回 0）
+ */
+Measurement measure(unsigned repeat, const std::function<uint64_t()>& run) {
+    Measurement result;
+    for (unsigned i = 0; i < repeat; ++i) {
+        uint64_t allocations = allocation_count.load(std::memory_order_relaxed);
+        auto start = Clock::now();
+        result.output_bytes = run();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.allocations = allocation_count.load(std::memory_order_relaxed) - allocations;
+        result.seconds = std::min(result.seconds, seconds);
+    }
+    return result;
+}
+
+void printHeader() {
+    std::cout << std::left << std::setw(22) << "benchmark" << std::right << std::setw(12) << "time ms"
+              << std::setw(12) << "MB/s" << std::setw(14) << "Mtokens/s" << std::setw(14) << "allocs/token"
+              << std::setw(12) << "output MB" << "\n";
+}
+
+void printMeasurement(const std::string& name, const Measurement& measurement, uint64_t bytes, size_t tokens) {
+    double seconds = std::max(measurement.seconds, 1e-9);
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << seconds * 1e3 << std::setw(12) << bytes / seconds / 1e6 << std::setw(14)
+              << tokens / seconds / 1e6 << std::setw(14)
+              << static_cast<double>(measurement.allocations) / std::max<size_t>(tokens, 1);
+    if (measurement.output_bytes != 0) {
+        std::cout << std::setw(12) << measurement.output_bytes / 1e6;
+    }
+    std::cout << "\n";
+}
+
+/**
+ * 把语料写入临时文件，供 readFile 测试使用
+ */
+std::filesystem::path writeTemporaryCorpus(const std::string& corpus) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                 ("dreamlang_bench." + std::to_string(std::random_device{}()) + ".zv");
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(corpus.data(), static_cast<std::streamsize>(corpus.size()));
+    file.close();
+    if (!file) {
+        throw std::runtime_error("cannot write " + path.string());
+    }
+    return path;
+}
+
+/**
+ * 增量分析的耗时：在随机的行首交替插入和删除一行，只统计 retokenize 本身
+ * 源码就地修改且预留了容量，缓冲区不会移动
+ * @param tokenize 分析完整源码，得到 Tokens
+ * @return 多次运行中最快一次的每次编辑平均耗时（秒）
+ */
+template <typename Tokens, typename Tokenize>
+double measureRetokenize(const std::string& corpus, unsigned repeat, Tokenize tokenize) {
+    constexpr int EDITS = 100;
+    const std::string line = "value = value + 1\n";
+    lexer::LexerOptions options;
+    options.value_mode = lexer::TokenValueMode::VIEW;
+
+    double best = std::numeric_limits<double>::max();
+    for (unsigned i = 0; i < repeat; ++i) {
+        std::string text;
+        text.reserve(corpus.size() + line.size());
+        text = corpus;
+        Tokens tokens = tokenize(text, options);
+        std::mt19937_64 random(i);
+        double seconds = 0;
+        auto retokenize = [&](const lexer::TextEdit& edit) {
+            auto lexer = lexer::Lexical::borrowed(text, options);
+            auto start = Clock::now();
+            lexer.retokenize(tokens, edit);
+            seconds += std::chrono::duration<double>(Clock::now() - start).count();
+        };
+        for (int edit = 0; edit < EDITS; ++edit) {
+            size_t offset = text.rfind('\n', random() % text.size());
+            offset = offset == std::string::npos ? 0 : offset + 1;
+            text.insert(offset, line);
+            retokenize({offset, 0, line.size()});
+            text.erase(offset, line.size());
+            retokenize({offset, line.size(), 0});
+        }
+        best = std::min(best, seconds / (2 * EDITS));
+    }
+    return best;
+}
+
+int runBenchmarks(const BenchOptions& options) {
+    std::string corpus = bench::CorpusGenerator(options.mix, options.seed).generate(options.size);
+    std::filesystem::path corpus_path = writeTemporaryCorpus(corpus);
+    struct RemoveOnExit {
+        const std::filesystem::path& path;
+        ~RemoveOnExit() {
+            std::error_code ignored;
+            std::filesystem::remove(path, ignored);
+        }
+    } remove_corpus{corpus_path};
+
+    // 先完整分析一遍：确认语料没有词法错误，并得到序列化测试的输入
+    lexer::LexerOptions view_options;
+    view_options.value_mode = lexer::TokenValueMode::VIEW;
+    std::vector<lexer::Token> tokens = lexer::Lexical::borrowed(corpus, view_options).tokenize();
+    size_t token_count = tokens.size();
+
+    std::cout << "corpus: " << corpus.size() << " bytes, mix " << options.mix_name << ", seed " << options.seed
+              << ", " << token_count << " tokens, best of " << options.repeat << "\n\n";
+    printHeader();
+
+    auto run = [&](const std::string& name, const std::function<uint64_t()>& body) {
+        if (name.find(options.filter) == std::string::npos) {
+            return;
+        }
+        printMeasurement(name, measure(options.repeat, body), corpus.size(), token_count);
+    };
+
+    run("readFile", [&] {
+        lexer::SourceBuffer source;
+        if (!source.open(corpus_path.string())) {
+            throw std::runtime_error("cannot open " + corpus_path.string());
+        }
+        // 映射的页面按需载入，逐页读取一个字节以计入载入的开销
+        std::string_view view = source.view();
+        volatile char sink = 0;
+        for (size_t offset = 0; offset < view.size(); offset += 4096) {
+            sink = sink + view[offset];
+        }
+        return uint64_t{0};
+    });
+
+    for (auto mode : {lexer::TokenValueMode::VIEW, lexer::TokenValueMode::OWNED}) {
+        lexer::LexerOptions lexer_options;
+        lexer_options.value_mode = mode;
+        std::string suffix = mode == lexer::TokenValueMode::VIEW ? "/view" : "/owned";
+
+        run("nextToken" + suffix, [&] {
+            auto lexer = lexer::Lexical::borrowed(corpus, lexer_options);
+            while (lexer.nextToken().getType() != lexer::TokenType::EOF_TOKEN) {
+            }
+            return uint64_t{0};
+        });
+        run("tokenize" + suffix, [&] {
+            std::vector<lexer::Token> result = lexer::Lexical::borrowed(corpus, lexer_options).tokenize();
+            return uint64_t{0};
+        });
+    }
+
+    lexer::LexerOptions table_options = view_options;
+    table_options.backend = lexer::LexerBackend::TABLE;
+    run("tokenize/table", [&] {
+        std::vector<lexer::Token> result = lexer::Lexical::borrowed(corpus, table_options).tokenize();
+        return uint64_t{0};
+    });
+    run("tokenizeParallel", [&] {
+        std::vector<lexer::Token> result = lexer::Lexical::borrowed(corpus, view_options).tokenizeParallel();
+        return uint64_t{0};
+    });
+    run("scan", [&] {
+        lexer::Lexical::borrowed(corpus, view_options).scan();
+        return uint64_t{0};
+    });
+
+    for (const char* format : {"json", "toml", "msgpack", "cbor"}) {
+        run(std::string("serialize/") + format, [&] {
+            CountingStreamBuffer counter;
+            std::ostream stream(&counter);
+            {
+                lexer::OutputBuffer out(stream);
+                lexer::serialize(tokens, format, out);
+            }
+            return counter.bytes;
+        });
+    }
+
+    // 增量分析按每次编辑的耗时报告：std::vector 要平移编辑之后的全部Token，分段保存只重建受影响的段
+    auto tokenize_vector = [](const std::string& text, const lexer::LexerOptions& lexer_options) {
+        return lexer::Lexical::borrowed(text, lexer_options).tokenize();
+    };
+    auto tokenize_segmented = [](const std::string& text, const lexer::LexerOptions& lexer_options) {
+        lexer::SegmentedTokens result;
+        lexer::Lexical::borrowed(text, lexer_options).tokenizeInto(result);
+        return result;
+    };
+    bool edit_header = false;
+    auto run_edits = [&](const std::string& name, const std::function<double()>& body) {
+        if (name.find(options.filter) == std::string::npos) {
+            return;
+        }
+        if (!edit_header) {
+            std::cout << "\n" << std::left << std::setw(22) << "benchmark" << std::right << std::setw(12) << "us/edit"
+                      << "\n";
+            edit_header = true;
+        }
+        std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << body() * 1e6 << "\n";
+    };
+    run_edits("retokenize/vector", [&] {
+        return measureRetokenize<std::vector<lexer::Token>>(corpus, options.repeat, tokenize_vector);
+    });
+    run_edits("retokenize/segmented", [&] {
+        return measureRetokenize<lexer::SegmentedTokens>(corpus, options.repeat, tokenize_segmented);
+    });
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    int status = 0;
+    if (!parseArguments(argc, argv, options, status)) {
+        return status;
+    }
+
+    try {
+        if (!options.write_path.empty()) {
+            // 边生成边写出，生成 1 GiB 语料也不需要同样大的内存
+            std::ofstream file(options.write_path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                std::cerr << "dreamlang_bench: cannot write " << options.write_path << "\n";
+                return 1;
+            }
+            {
+                lexer::OutputBuffer out(file, 1024 * 1024);
+                bench::CorpusGenerator(options.mix, options.seed).generate(out, options.size);
+            }
+            file.close();
+            if (!file) {
+                std::cerr << "dreamlang_bench: cannot write " << options.write_path << "\n";
+                return 1;
+            }
+            return 0;
+        }
+        return runBenchmarks(options);
+    } catch (const lexer::LexicalException& e) {
+        std::cerr << "dreamlang_bench: generated corpus has a lexical error: " << e.what() << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "dreamlang_bench: " << e.what() << "\n";
+    }
+    return 1;
+}
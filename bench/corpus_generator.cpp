@@ -0,0 +1,343 @@
+#include "corpus_generator.h"
+#include <stdexcept>
+#include <vector>
+
+namespace dreamlang::bench {
+
+namespace {
+
+constexpr const char* WORDS[] = {
+    "value", "count", "index", "buffer", "node",   "left",   "right",  "parent", "result", "total",
+    "name",  "item",  "list",  "map",    "key",    "offset", "length", "source", "target", "state",
+    "token", "scope", "frame", "stack",  "queue",  "cache",  "entry",  "range",  "limit",  "flag",
+};
+
+constexpr const char* KEYWORDS[] = {"this", "super", "null", "true", "false"};
+
+constexpr const char* TYPES[] = {"bool", "number", "char", "string", "array", "object"};
+
+constexpr const char* BINARY_OPERATORS[] = {"+", "-", "*", "/", "%", "**", "&&", "||"};
+
+constexpr const char* COMPARISONS[] = {"==", "!=", ">", "<", ">=", "<="};
+
+constexpr const char* ESCAPES[] = {"\\n", "\\t", "\\r", "\\b", "\\f", "\\\\", "\\'", "\\\"", "\\0"};
+
+// 嵌套块的括号对
+constexpr const char* OPENERS[] = {"{", "[", "("};
+constexpr const char* CLOSERS[] = {"}", "]", ")"};
+
+constexpr const char* HEX_DIGITS = "0123456789abcdefABCDEF";
+
+template <typename T, size_t N>
+constexpr size_t countOf(const T (&)[N]) {
+    return N;
+}
+
+} // namespace
+
+std::optional<CorpusMix> findCorpusMix(const std::string& name) {
+    if (name == "mixed") {
+        return CorpusMix{};
+    }
+    if (name == "identifiers") {
+        return CorpusMix{1, 0, 0, 0, 0};
+    }
+    if (name == "comments") {
+        return CorpusMix{1, 6, 0, 0, 0};
+    }
+    if (name == "strings") {
+        return CorpusMix{1, 0, 6, 0, 0};
+    }
+    if (name == "numbers") {
+        return CorpusMix{1, 0, 0, 6, 0};
+    }
+    if (name == "nested") {
+        return CorpusMix{1, 0, 0, 0, 6};
+    }
+    return std::nullopt;
+}
+
+CorpusGenerator::CorpusGenerator(const CorpusMix& mix, uint64_t seed) : mix_(mix), state_(seed) {
+    if (mix_.identifiers + mix_.comments + mix_.strings + mix_.numbers + mix_.nesting == 0) {
+        throw std::invalid_argument("corpus mix has no content");
+    }
+}
+
+void CorpusGenerator::generate(lexer::OutputBuffer& out, uint64_t size) {
+    uint64_t written = 0;
+    while (true) {
+        chunk_.clear();
+        appendChunk();
+        if (chunk_.size() > size - written) {
+            break;
+        }
+        out.write(chunk_);
+        written += chunk_.size();
+    }
+
+    // 剩余空间放不下一整段内容，用单行注释补足；不够放注释时用空行
+    uint64_t remaining = size - written;
+    if (remaining >= 3) {
+        out.write("//");
+        out.fill('-', static_cast<size_t>(remaining - 3));
+        out.put('\n');
+    } else {
+        out.fill('\n', static_cast<size_t>(remaining));
+    }
+}
+
+std::string CorpusGenerator::generate(size_t size) {
+    std::string result;
+    result.reserve(size);
+    {
+        lexer::OutputBuffer out(result);
+        generate(out, size);
+    }
+    return result;
+}
+
+void CorpusGenerator::appendChunk() {
+    uint64_t total = mix_.identifiers + mix_.comments + mix_.strings + mix_.numbers + mix_.nesting;
+    uint64_t pick = below(total);
+    if (pick < mix_.identifiers) {
+        appendStatement();
+        return;
+    }
+    pick -= mix_.identifiers;
+    if (pick < mix_.comments) {
+        appendComment();
+        return;
+    }
+    pick -= mix_.comments;
+    if (pick < mix_.strings) {
+        appendString();
+        return;
+    }
+    pick -= mix_.strings;
+    if (pick < mix_.numbers) {
+        appendNumbers();
+        return;
+    }
+    appendNesting();
+}
+
+void CorpusGenerator::appendStatement() {
+    switch (below(4)) {
+    case 0:
+        // var name: type = a + b
+        chunk_ += below(2) == 0 ? "var " : "val ";
+        appendIdentifier();
+        chunk_ += ": ";
+        chunk_ += TYPES[below(countOf(TYPES))];
+        chunk_ += " = ";
+        appendIdentifier();
+        for (uint64_t i = below(4); i > 0; --i) {
+            chunk_ += ' ';
+            chunk_ += BINARY_OPERATORS[below(countOf(BINARY_OPERATORS))];
+            chunk_ += ' ';
+            appendIdentifier();
+        }
+        break;
+    case 1:
+        // a.b(c, d)
+        appendIdentifier();
+        chunk_ += '.';
+        appendIdentifier();
+        chunk_ += '(';
+        for (uint64_t i = below(4); i > 0; --i) {
+            appendIdentifier();
+            if (i > 1) {
+                chunk_ += ", ";
+            }
+        }
+        chunk_ += ')';
+        break;
+    case 2:
+        // if a >= b && !c { return d } else { break }
+        chunk_ += "if ";
+        appendIdentifier();
+        chunk_ += ' ';
+        chunk_ += COMPARISONS[below(countOf(COMPARISONS))];
+        chunk_ += ' ';
+        appendIdentifier();
+        chunk_ += " && !";
+        appendIdentifier();
+        chunk_ += " { return ";
+        appendIdentifier();
+        chunk_ += below(2) == 0 ? " } else { break }" : " }";
+        break;
+    default:
+        // for item in list { a = a[item] }
+        chunk_ += "for ";
+        appendIdentifier();
+        chunk_ += " in ";
+        appendIdentifier();
+        chunk_ += " { ";
+        appendIdentifier();
+        chunk_ += " = ";
+        appendIdentifier();
+        chunk_ += '[';
+        appendIdentifier();
+        chunk_ += "] }";
+        break;
+    }
+    chunk_ += '\n';
+}
+
+void CorpusGenerator::appendComment() {
+    if (below(3) == 0) {
+        chunk_ += "/*\n";
+        for (uint64_t lines = 1 + below(4); lines > 0; --lines) {
+            chunk_ += " *";
+            for (uint64_t words = 3 + below(8); words > 0; --words) {
+                chunk_ += ' ';
+                appendWord();
+            }
+            chunk_ += '\n';
+        }
+        chunk_ += " */\n";
+        return;
+    }
+    chunk_ += "//";
+    for (uint64_t words = 3 + below(10); words > 0; --words) {
+        chunk_ += ' ';
+        appendWord();
+    }
+    chunk_ += '\n';
+}
+
+void CorpusGenerator::appendString() {
+    chunk_ += "val ";
+    appendIdentifier();
+    chunk_ += " = \"";
+    // 约一半的字符串含转义，需要解码后另外保存
+    bool escaped = below(2) == 0;
+    for (uint64_t words = 2 + below(10); words > 0; --words) {
+        appendWord();
+        if (escaped && below(3) == 0) {
+            chunk_ += ESCAPES[below(countOf(ESCAPES))];
+        } else if (words > 1) {
+            chunk_ += ' ';
+        }
+    }
+    chunk_ += '"';
+    if (below(2) == 0) {
+        chunk_ += " + '";
+        if (below(3) == 0) {
+            chunk_ += ESCAPES[below(countOf(ESCAPES))];
+        } else {
+            chunk_ += static_cast<char>('a' + below(26));
+        }
+        chunk_ += '\'';
+    }
+    chunk_ += '\n';
+}
+
+void CorpusGenerator::appendNumbers() {
+    chunk_ += "var ";
+    appendIdentifier();
+    chunk_ += " = ";
+    for (uint64_t terms = 2 + below(5); terms > 0; --terms) {
+        switch (below(5)) {
+        case 0: {
+            chunk_ += below(2) == 0 ? "0x" : "0X";
+            for (uint64_t digits = 1 + below(15); digits > 0; --digits) {
+                chunk_ += HEX_DIGITS[below(22)];
+            }
+            break;
+        }
+        case 1:
+            chunk_ += below(2) == 0 ? "0b" : "0B";
+            for (uint64_t digits = 1 + below(62); digits > 0; --digits) {
+                chunk_ += static_cast<char>('0' + below(2));
+            }
+            break;
+        case 2:
+            chunk_ += below(2) == 0 ? "0o" : "0O";
+            for (uint64_t digits = 1 + below(20); digits > 0; --digits) {
+                chunk_ += static_cast<char>('0' + below(8));
+            }
+            break;
+        case 3:
+            // 不超过 18 位，不会超出 int64 范围
+            chunk_ += std::to_string(below(1000000000000000000ULL) >> below(60));
+            break;
+        default:
+            chunk_ += std::to_string(below(100000));
+            chunk_ += '.';
+            chunk_ += std::to_string(below(1000000));
+            if (below(2) == 0) {
+                chunk_ += below(2) == 0 ? "e-" : "E";
+                chunk_ += std::to_string(below(300));
+            }
+            break;
+        }
+        if (terms > 1) {
+            chunk_ += ' ';
+            chunk_ += BINARY_OPERATORS[below(5)];
+            chunk_ += ' ';
+        }
+    }
+    chunk_ += '\n';
+}
+
+void CorpusGenerator::appendNesting() {
+    size_t depth = 8 + below(57);
+    std::vector<size_t> kinds;
+    kinds.reserve(depth);
+
+    chunk_ += "fun ";
+    appendIdentifier();
+    chunk_ += "() {\n";
+    for (size_t level = 0; level < depth; ++level) {
+        size_t kind = below(countOf(OPENERS));
+        kinds.push_back(kind);
+        chunk_.append(level + 1, ' ');
+        appendIdentifier();
+        chunk_ += ' ';
+        chunk_ += OPENERS[kind];
+        chunk_ += '\n';
+    }
+    for (size_t level = depth; level > 0; --level) {
+        chunk_.append(level, ' ');
+        chunk_ += CLOSERS[kinds[level - 1]];
+        chunk_ += '\n';
+    }
+    chunk_ += "}\n";
+}
+
+void CorpusGenerator::appendIdentifier() {
+    uint64_t pick = below(16);
+    if (pick == 0) {
+        chunk_ += KEYWORDS[below(countOf(KEYWORDS))];
+        return;
+    }
+    appendWord();
+    if (pick < 6) {
+        // 短标识符，常见于循环变量
+        return;
+    }
+    if (pick < 11) {
+        chunk_ += '_';
+        appendWord();
+        return;
+    }
+    // 带编号的标识符，让符号表里有大量不同的名字
+    chunk_ += std::to_string(below(10000));
+}
+
+void CorpusGenerator::appendWord() {
+    chunk_ += WORDS[below(countOf(WORDS))];
+}
+
+uint64_t CorpusGenerator::below(uint64_t bound) {
+    // splitmix64，各平台结果相同
+    state_ += 0x9e3779b97f4a7c15ULL;
+    uint64_t z = state_;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return z % bound;
+}
+
+} // namespace dreamlang::bench
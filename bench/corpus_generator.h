@@ -0,0 +1,89 @@
+#pragma once
+
+#include "lexer/output_buffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace dreamlang::bench {
+
+/**
+ * 语料中各类内容的权重，每一段内容按权重随机选取
+ */
+struct CorpusMix {
+    // 由标识符、关键字和运算符组成的语句
+    unsigned identifiers = 4;
+    // 单行和多行注释
+    unsigned comments = 1;
+    // 字符串和字符字面量，部分含转义
+    unsigned strings = 1;
+    // 十进制、十六进制、二进制、八进制整数和浮点数
+    unsigned numbers = 1;
+    // 深层嵌套的大括号、中括号和小括号
+    unsigned nesting = 1;
+};
+
+/**
+ * 按名称获取预设的混合：mixed、identifiers、comments、strings、numbers、nested
+ * @return 未知名称时为空
+ */
+std::optional<CorpusMix> findCorpusMix(const std::string& name);
+
+/**
+ * 确定性的 .zv 语料生成器：大小、混合和种子相同时生成的内容逐字节相同，与平台无关
+ * 生成的源码都能无错误地通过词法分析
+ */
+class CorpusGenerator {
+public:
+    /**
+     * 构造函数
+     * @param mix 各类内容的权重，不能全为 0
+     * @param seed 随机种子
+     */
+    explicit CorpusGenerator(const CorpusMix& mix, uint64_t seed = 1);
+
+    /**
+     * 生成恰好 size 字节的语料写入输出缓冲区，边生成边写出，内存占用与 size 无关
+     * 最后放不下一整段内容时用单行注释（或换行）补足
+     */
+    void generate(lexer::OutputBuffer& out, uint64_t size);
+
+    /**
+     * 生成恰好 size 字节的语料
+     */
+    std::string generate(size_t size);
+
+private:
+    /**
+     * 生成一段内容（一行或多行，以换行结尾）追加到 chunk_
+     */
+    void appendChunk();
+
+    void appendStatement();
+    void appendComment();
+    void appendString();
+    void appendNumbers();
+    void appendNesting();
+
+    /**
+     * 追加一个随机标识符（偶尔是关键字或字面量关键字）
+     */
+    void appendIdentifier();
+
+    /**
+     * 追加一个随机单词，用于注释和字符串内容
+     */
+    void appendWord();
+
+    /**
+     * 获取 [0, bound) 中的随机数
+     */
+    uint64_t below(uint64_t bound);
+
+    CorpusMix mix_;
+    uint64_t state_;
+    std::string chunk_;
+};
+
+} // namespace dreamlang::bench
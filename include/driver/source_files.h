@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace dreamlang::driver {
+
+/**
+ * 源文件扩展名
+ */
+inline constexpr const char* SOURCE_EXTENSION = ".zv";
+
+/**
+ * 表示从标准输入读取源码的文件名
+ */
+inline constexpr const char* STDIN_SOURCE = "-";
+
+/**
+ * 解析命令行中的源文件名，没有扩展名且存在同名 .zv 文件时自动补全后缀
+ * @param filename 命令行给出的文件名
+ * @return 实际使用的文件名，找不到时原样返回（由后续读取报错）
+ */
+std::string resolveSourceFile(const std::string& filename);
+
+/**
+ * 展开命令行给出的源文件和目录
+ * 目录递归查找 *.zv 文件（跳过以 '.' 开头的隐藏目录，如 .tokens），同一目录下的结果按路径排序；
+ * "-" 原样保留（标准输入），其他参数按 resolveSourceFile 处理。结果保持命令行中的顺序，保证输出顺序确定。
+ * @param inputs 命令行给出的路径
+ * @param has_directory 输出参数，输入中是否包含目录
+ * @return 待处理的源文件列表
+ */
+std::vector<std::string> collectSourceFiles(const std::vector<std::string>& inputs, bool& has_directory);
+
+} // namespace dreamlang::driver
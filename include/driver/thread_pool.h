@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dreamlang::driver {
+
+/**
+ * 工作窃取线程池
+ *
+ * 每个工作线程有自己的任务队列，按提交顺序从队首取自己的任务，空闲时从其他线程的队首窃取，
+ * 因此任务大致按提交顺序开始，按顺序消费结果的调用者（如逐文件打印）可以边完成边输出。
+ * 任务只在各队列自己的互斥锁下出入队；待执行和未完成任务的计数以及空闲线程的休眠与唤醒
+ * 共用一个状态锁，每个任务在提交、开始和结束时各短暂持有一次。
+ * 适合大量大小不一的独立任务（如逐文件词法分析）。
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * 构造函数
+     * @param threads 工作线程数，0 表示使用硬件并发数
+     */
+    explicit ThreadPool(unsigned threads = 0);
+
+    /**
+     * 析构函数，等待所有已提交的任务完成
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * 提交任务，任务按轮转方式分配到各工作线程的队列，每个队列先进先出
+     * 任务抛出的异常会被忽略，调用者应在任务内部处理错误
+     */
+    void submit(Task task);
+
+    /**
+     * 阻塞直到所有已提交的任务完成
+     */
+    void wait();
+
+    /**
+     * 获取工作线程数
+     */
+    size_t size() const { return queues_.size(); }
+
+private:
+    /**
+     * 单个工作线程的任务队列
+     */
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(size_t self);
+    bool popLocal(size_t self, Task& task);
+    bool steal(size_t self, Task& task);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_queue_;
+
+    // 保护下面的计数并用于空闲线程的休眠与唤醒，不保护任务队列
+    std::mutex state_mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable all_done_;
+    size_t queued_;
+    size_t unfinished_;
+    bool stopping_;
+};
+
+} // namespace dreamlang::driver
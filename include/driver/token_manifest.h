@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace dreamlang::driver {
+
+/**
+ * .tokens 目录中清单文件的文件名
+ */
+inline constexpr const char* MANIFEST_FILENAME = "manifest";
+
+/**
+ * 清单中一个源文件的记录
+ */
+struct ManifestEntry {
+    // 生成 .tokens 输出时源码的内容哈希和长度
+    uint64_t hash = 0;
+    uint64_t size = 0;
+    // Token数量
+    size_t tokens = 0;
+};
+
+/**
+ * 原子地写入文件：先写入同目录下的临时文件，再重命名为目标文件
+ * 读者（包括并发运行的其他进程）只会看到完整的旧文件或新文件
+ * @param path 目标文件
+ * @param content 文件内容
+ * @return 是否成功（失败时目标文件保持不变）
+ */
+bool writeFileAtomically(const std::filesystem::path& path, std::string_view content);
+
+/**
+ * 原子地写入文件，内容由回调直接写入临时文件的流，不需要先在内存中生成完整内容
+ * @param path 目标文件
+ * @param write 写入内容的回调
+ * @return 是否成功（失败时目标文件保持不变）
+ */
+bool writeFileAtomically(const std::filesystem::path& path, const std::function<void(std::ostream&)>& write);
+
+/**
+ * 各 .tokens 目录的清单，供并行处理的文件共享（线程安全）
+ *
+ * 清单记录每个源文件生成输出时的内容哈希，以及生成它们的词法分析器版本和相关配置（合称 key）。
+ * key 不同的清单整体视为无效。查询时按需读取目录中的清单，更新先记录在内存中，由 save() 统一写回。
+ */
+class ManifestCache {
+public:
+    /**
+     * 构造函数
+     * @param key 词法分析器版本和影响输出的配置，不能包含换行
+     */
+    explicit ManifestCache(std::string key);
+
+    ManifestCache(const ManifestCache&) = delete;
+    ManifestCache& operator=(const ManifestCache&) = delete;
+
+    /**
+     * 查找源文件的记录
+     * @param tokens_dir .tokens 目录
+     * @param name 源文件名（不含目录）
+     */
+    std::optional<ManifestEntry> find(const std::filesystem::path& tokens_dir, const std::string& name);
+
+    /**
+     * 记录源文件新生成的输出
+     */
+    void update(const std::filesystem::path& tokens_dir, const std::string& name, const ManifestEntry& entry);
+
+    /**
+     * 把更新写回各目录的清单
+     * 写入前重新读取磁盘上的清单，保留其他进程在此期间写入的记录，再整体原子替换
+     * @return 写入失败的目录数
+     */
+    size_t save();
+
+private:
+    using Entries = std::map<std::string, ManifestEntry>;
+
+    /**
+     * 读取目录中的清单，文件不存在、格式错误或 key 不同时为空
+     */
+    Entries load(const std::filesystem::path& tokens_dir) const;
+
+    std::string key_;
+    std::mutex mutex_;
+    // 已读取的清单，按目录
+    std::map<std::filesystem::path, Entries> loaded_;
+    // 尚未写回的更新，按目录
+    std::map<std::filesystem::path, Entries> pending_;
+};
+
+} // namespace dreamlang::driver
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "message_catalog.h"
+// 标准库的 <locale> 可能引入 <libintl.h>，须在定义下面的 ngettext 宏之前包含
+#include <locale>
 #include <memory>
 
 namespace dreamlang::i18n {
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace dreamlang::lexer {
+
+/**
+ * 计算内容的 64 位哈希（XXH64 算法）
+ * 每次处理 32 字节，速度接近内存带宽，用于判断源文件内容是否变化，不具备密码学强度。
+ * 结果与官方 xxHash 在小端平台上的 XXH64 一致
+ * @param data 内容
+ * @param seed 种子
+ */
+uint64_t contentHash(std::string_view data, uint64_t seed = 0);
+
+} // namespace dreamlang::lexer
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+
+/**
+ * 是否启用了 C++ 异常
+ * 以 -fno-exceptions 构建时为 0：词法错误总是以 ILLEGAL Token 加诊断信息报告，
+ * 其他无法报告的错误（如读取失败）直接终止程序
+ */
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define DREAMLANG_HAS_EXCEPTIONS 1
+#define DREAMLANG_THROW(exception) throw exception
+#else
+#define DREAMLANG_HAS_EXCEPTIONS 0
+#define DREAMLANG_THROW(exception) ((void)sizeof(exception), std::abort())
+#endif
+
+namespace dreamlang::lexer {
+
+/**
+ * 词法错误代码
+ */
+enum class LexicalErrorCode {
+    // 单独的 & 或 |
+    INVALID_CHARACTER,
+    // 不能开始任何Token的字符
+    UNEXPECTED_CHARACTER,
+    // 未结束的多行注释
+    UNTERMINATED_COMMENT,
+    // 0x 之后没有十六进制数字
+    INVALID_HEX_NUMBER,
+    // 0b 之后没有二进制数字
+    INVALID_BINARY_NUMBER,
+    // 0o 之后没有八进制数字
+    INVALID_OCTAL_NUMBER,
+    // 指数部分没有数字
+    INVALID_NUMBER_FORMAT,
+    // 未结束的字符串
+    UNTERMINATED_STRING,
+    // 未结束的字符字面量
+    UNTERMINATED_CHAR,
+    // 无效的转义序列
+    INVALID_ESCAPE,
+    // 整数超出 int64 范围，或浮点数超出 double 范围
+    NUMBER_OUT_OF_RANGE
+};
+
+/**
+ * 一条词法诊断信息
+ */
+struct Diagnostic {
+    LexicalErrorCode code = LexicalErrorCode::UNEXPECTED_CHARACTER;
+    // 出错位置的字节偏移
+    size_t offset = 0;
+    int line = 0;
+    int column = 0;
+    // 引起错误的字符
+    char character = '\0';
+};
+
+/**
+ * 获取错误代码对应的错误消息（未翻译的消息标识）
+ */
+const char* lexicalErrorMessage(LexicalErrorCode code);
+
+/**
+ * 获取错误代码对应的Token类型名称
+ */
+const char* lexicalErrorTokenType(LexicalErrorCode code);
+
+} // namespace dreamlang::lexer
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "token_type.h"
+#include <cstddef>
+#include <string_view>
+
+namespace dreamlang::lexer {
+
+namespace detail {
+
+/**
+ * 关键字表项
+ */
+struct KeywordEntry {
+    std::string_view text;
+    TokenType type;
+};
+
+/**
+ * 全部关键字及特殊字面量
+ */
+inline constexpr KeywordEntry KEYWORD_ENTRIES[] = {
+    {"bool", TokenType::KEYWORD}, {"number", TokenType::KEYWORD}, {"char", TokenType::KEYWORD},
+    {"string", TokenType::KEYWORD}, {"function", TokenType::KEYWORD}, {"array", TokenType::KEYWORD},
+    {"class", TokenType::KEYWORD}, {"object", TokenType::KEYWORD}, {"reference", TokenType::KEYWORD},
+    {"package", TokenType::KEYWORD}, {"import", TokenType::KEYWORD}, {"var", TokenType::KEYWORD},
+    {"val", TokenType::KEYWORD}, {"ref", TokenType::KEYWORD}, {"return", TokenType::KEYWORD},
+    {"fun", TokenType::KEYWORD}, {"if", TokenType::KEYWORD}, {"else", TokenType::KEYWORD},
+    {"for", TokenType::KEYWORD}, {"while", TokenType::KEYWORD}, {"break", TokenType::KEYWORD},
+    {"continue", TokenType::KEYWORD}, {"switch", TokenType::KEYWORD}, {"case", TokenType::KEYWORD},
+    {"default", TokenType::KEYWORD}, {"super", TokenType::KEYWORD}, {"this", TokenType::KEYWORD},
+    {"available", TokenType::KEYWORD}, {"in", TokenType::KEYWORD}, {"interface", TokenType::KEYWORD},
+    {"abstract", TokenType::KEYWORD},
+    {"null", TokenType::NULL_LITERAL}, {"true", TokenType::BOOL_TRUE}, {"false", TokenType::BOOL_FALSE},
+};
+
+inline constexpr size_t KEYWORD_MIN_LENGTH = 2;
+inline constexpr size_t KEYWORD_MAX_LENGTH = 9;
+inline constexpr size_t KEYWORD_TABLE_SIZE = 64;
+
+/**
+ * 关键字哈希：长度、前两个字符和最后一个字符的线性组合
+ * 系数经过挑选，使上面的关键字在 64 个槽中互不冲突（由下方的 static_assert 保证）
+ * 调用者需保证 text 至少有 KEYWORD_MIN_LENGTH 个字符
+ */
+constexpr size_t keywordHash(std::string_view text) {
+    return (text.size() +
+            static_cast<unsigned char>(text[0]) * 17u +
+            static_cast<unsigned char>(text[1]) * 19u +
+            static_cast<unsigned char>(text[text.size() - 1]) * 25u) & (KEYWORD_TABLE_SIZE - 1);
+}
+
+/**
+ * 以哈希值为下标的关键字表，空槽的 text 为空
+ */
+struct KeywordTable {
+    KeywordEntry slots[KEYWORD_TABLE_SIZE] = {};
+    bool perfect = true;
+};
+
+constexpr KeywordTable buildKeywordTable() {
+    KeywordTable table;
+    for (const auto& entry : KEYWORD_ENTRIES) {
+        if (entry.text.size() < KEYWORD_MIN_LENGTH || entry.text.size() > KEYWORD_MAX_LENGTH) {
+            table.perfect = false;
+            continue;
+        }
+        KeywordEntry& slot = table.slots[keywordHash(entry.text)];
+        if (!slot.text.empty()) {
+            table.perfect = false;
+        }
+        slot = entry;
+    }
+    return table;
+}
+
+inline constexpr KeywordTable KEYWORD_TABLE = buildKeywordTable();
+
+static_assert(KEYWORD_TABLE.perfect, "keyword hash has collisions, pick new coefficients for keywordHash");
+
+} // namespace detail
+
+/**
+ * 查找标识符对应的Token类型
+ * 编译期生成的完美哈希表，无需运行时初始化，也不分配内存
+ * @param text 标识符文本
+ * @return KEYWORD、NULL_LITERAL、BOOL_TRUE、BOOL_FALSE 之一，不是关键字时返回 IDENT
+ */
+constexpr TokenType lookupKeyword(std::string_view text) {
+    if (text.size() < detail::KEYWORD_MIN_LENGTH || text.size() > detail::KEYWORD_MAX_LENGTH) {
+        return TokenType::IDENT;
+    }
+    const detail::KeywordEntry& slot = detail::KEYWORD_TABLE.slots[detail::keywordHash(text)];
+    return slot.text == text ? slot.type : TokenType::IDENT;
+}
+
+static_assert(lookupKeyword("interface") == TokenType::KEYWORD);
+static_assert(lookupKeyword("null") == TokenType::NULL_LITERAL);
+static_assert(lookupKeyword("nul") == TokenType::IDENT);
+
+} // namespace dreamlang::lexer
@@ -1,55 +1,333 @@
 #pragma once
 
 #include "token.h"
+#include "token_buffer.h"
+#include "segmented_tokens.h"
+#include "token_arena.h"
+#include "symbol_table.h"
+#include "diagnostic.h"
 #include "lexical_exception.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_set>
 
 namespace dreamlang::lexer {
 
+/**
+ * 词法分析结果的版本：Token的划分、类型、值、行号或错误的判定改变时递增，已生成的 .tokens 缓存随之失效
+ * 2：Token记录起始行而不是结束行
+ */
+constexpr uint32_t LEXER_OUTPUT_VERSION = 2;
+
+/**
+ * Token值的存储方式
+ */
+enum class TokenValueMode {
+    // Token持有值的副本
+    OWNED,
+    // Token值指向词法分析器的源码缓冲区，只有含转义的字面量才持有解码后的副本
+    VIEW
+};
+
+/**
+ * 词法分析后端
+ */
+enum class LexerBackend {
+    // 逐字符判断加 switch 分派
+    SWITCH,
+    // 字符类别表加状态转移表，依赖源码末尾的 '\0' 哨兵
+    TABLE
+};
+
+/**
+ * 词法分析器选项
+ */
+struct LexerOptions {
+    TokenValueMode value_mode = TokenValueMode::OWNED;
+    LexerBackend backend = LexerBackend::SWITCH;
+    // 为 false 时扫描过程中不维护行号，Token的行号为 0，
+    // 需要时通过 lineOf/columnOf 按偏移查询
+    bool track_positions = true;
+    // 为 true 时词法错误不抛出异常：记录诊断信息，把出错的文本作为 ILLEGAL Token 返回，
+    // 然后从下一个安全位置继续分析（不启用异常的构建中总是如此）
+    bool recover_errors = false;
+    // 恢复模式下最多记录的错误数，达到后返回EOF Token 提前结束；为 0 时不限制
+    size_t max_errors = 0;
+    // 不为空时把每个标识符驻留到这张表中，ID 记录在Token里（见 Token::getSymbol）；
+    // OWNED 模式下标识符的值直接引用表中的文本，不再逐个拷贝。表需比Token活得更久，可被多个词法分析器共用
+    SymbolTable* symbols = nullptr;
+};
+
+/**
+ * 不抛出词法错误的分析结果
+ */
+struct LexResult {
+    // 以EOF Token结尾，出错的位置是 ILLEGAL Token
+    std::vector<Token> tokens;
+    // 按出现顺序排列的诊断信息
+    std::vector<Diagnostic> diagnostics;
+    // 是否因为达到 max_errors 而提前结束
+    bool stopped = false;
+
+    /**
+     * 检查是否没有任何错误
+     */
+    [[nodiscard]] bool ok() const { return diagnostics.empty(); }
+};
+
+/**
+ * 只扫描不保存Token的结果，见 Lexical::scan()
+ */
+struct ScanSummary {
+    // Token总数，含EOF Token
+    size_t tokens = 0;
+    // 各类型的Token数，以 TokenType 的值为下标
+    std::array<size_t, TOKEN_TYPE_COUNT> counts{};
+};
+
+/**
+ * 一次源码编辑：旧源码中 [offset, offset + old_length) 被替换为新源码中 [offset, offset + new_length)
+ */
+struct TextEdit {
+    size_t offset = 0;
+    size_t old_length = 0;
+    size_t new_length = 0;
+};
+
+/**
+ * 增量分析的结果：tokens 中 [first, first + inserted) 是新产生的Token，
+ * 替换了原来的 removed 个Token，之后的Token只是平移了位置
+ */
+struct TokenSplice {
+    size_t first = 0;
+    size_t removed = 0;
+    size_t inserted = 0;
+};
+
 /**
  * 词法分析器类
  */
 class Lexical {
 public:
+    /**
+     * 逐个取Token的输入迭代器，见 begin()
+     * 持有当前Token，自增时才分析下一个Token；与 std::istream_iterator 一样只能单遍使用
+     */
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Token;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Token*;
+        using reference = const Token&;
+
+        Iterator() : lexer_(nullptr), token_(TokenType::EOF_TOKEN, std::string(), 0) {}
+
+        const Token& operator*() const { return token_; }
+        const Token* operator->() const { return &token_; }
+
+        Iterator& operator++();
+        Iterator operator++(int) { Iterator old = *this; ++*this; return old; }
+
+        /**
+         * 检查是否已经取到EOF Token
+         */
+        [[nodiscard]] bool atEnd() const { return token_.getType() == TokenType::EOF_TOKEN; }
+
+        bool operator==(const Iterator& other) const { return atEnd() && other.atEnd(); }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class Lexical;
+
+        explicit Iterator(Lexical* lexer) : lexer_(lexer), token_(lexer->nextToken()) {}
+
+        Lexical* lexer_;
+        Token token_;
+    };
+
+    /**
+     * 与 Iterator 比较的结束哨兵，迭代器取到EOF Token时与它相等（EOF Token本身不会被遍历到）
+     */
+    struct Sentinel {
+        friend bool operator==(const Iterator& it, Sentinel) { return it.atEnd(); }
+        friend bool operator==(Sentinel, const Iterator& it) { return it.atEnd(); }
+        friend bool operator!=(const Iterator& it, Sentinel) { return !it.atEnd(); }
+        friend bool operator!=(Sentinel, const Iterator& it) { return !it.atEnd(); }
+    };
+
     /**
      * 构造函数
      * @param source_code 源代码字符串
+     * @param options 词法分析器选项
      */
-    explicit Lexical(std::string source_code);
+    explicit Lexical(std::string source_code, LexerOptions options = {});
+
+    /**
+     * 创建引用外部源码的词法分析器，不拷贝源码（例如直接分析 SourceBuffer 映射的文件）
+     * 调用者需保证源码比词法分析器和它产生的 VIEW Token 活得更久，
+     * 且 source_code.data()[source_code.size()] 可读并为 '\0'（std::string 和 SourceBuffer 都满足）
+     * @param source_code 源代码
+     * @param options 词法分析器选项
+     */
+    static Lexical borrowed(std::string_view source_code, LexerOptions options = {});
 
     /**
      * 析构函数
      */
     ~Lexical() = default;
 
+    // Token和内部视图都指向源码缓冲区，禁止拷贝和移动
+    Lexical(const Lexical&) = delete;
+    Lexical& operator=(const Lexical&) = delete;
+
     /**
      * 获取下一个Token
      * @return 下一个Token，如果到达文件末尾则返回EOF Token
      */
     Token nextToken();
 
+    /**
+     * 从当前位置开始按需逐个取Token，可直接用于范围 for 循环，
+     * 在 C++20 中满足 std::ranges::input_range，可以与 std::views::filter、std::views::take_while 等组合。
+     * 只在迭代器自增时调用 nextToken()，提前停止时不会分析剩余的源码；
+     * 每次调用都从当前位置继续，需要从头开始时先调用 reset()
+     */
+    Iterator begin() { return Iterator(this); }
+
+    /**
+     * 获取结束哨兵，见 begin()
+     */
+    Sentinel end() const { return {}; }
+
     /**
      * 获取所有Token
+     * VIEW 模式下返回的Token引用词法分析器的源码，不能比词法分析器活得更久
      * @return Token列表
      */
     std::vector<Token> tokenize();
 
     /**
-     * 重置词法分析器到起始位置
+     * 获取所有Token，Token数组和Token的值都从调用者提供的内存资源分配
+     * 含转义的字面量解码到内存资源中，OWNED 模式下其余Token的值也拷贝到内存资源中（此时不再依赖源码）。
+     * 返回的Token都不持有值，其值在内存资源释放前有效，不能交给 retokenize
+     * @param resource 内存资源，例如 std::pmr::monotonic_buffer_resource
+     * @return Token列表
+     */
+    std::pmr::vector<Token> tokenize(std::pmr::memory_resource* resource);
+
+    /**
+     * 获取所有Token并写入 arena，原有内容会被清空（见 tokenize(std::pmr::memory_resource*)）
+     * @param arena 输出 arena
+     */
+    void tokenizeInto(TokenArena& arena);
+
+    /**
+     * 获取所有Token，词法错误总是按恢复模式处理（不论 recover_errors 选项），从不抛出 LexicalException
+     * @return Token列表和诊断信息
+     */
+    LexResult tryTokenize();
+
+    /**
+     * 从当前位置扫描到末尾，只统计各类型的Token数
+     * 与 tokenize() 走同一个状态机，接受的语言和报告的错误完全相同，
+     * 但不保存Token、不拷贝含转义字面量的解码结果、不驻留标识符，适合只需要检查和计数的场合
+     * @return 统计结果
+     * @throws LexicalException 非恢复模式下遇到词法错误
+     */
+    ScanSummary scan();
+
+    /**
+     * 获取所有Token并写入列式缓冲区
+     * 缓冲区引用词法分析器的源码，不能比词法分析器活得更久
+     * @param buffer 输出缓冲区，原有内容会被清空
+     */
+    void tokenizeInto(TokenBuffer& buffer);
+
+    /**
+     * 多线程获取所有Token（从源码开头开始）
+     * 源码按行切分为若干块并行推测分析，再顺序校正块边界，
+     * 结果（包括行号、符号 ID 和抛出的词法错误）与 tokenize() 完全一致
+     * @param threads 线程数，为 0 时使用硬件并发数
+     * @return Token列表
+     */
+    std::vector<Token> tokenizeParallel(unsigned threads = 0);
+
+    /**
+     * 增量重新分析
+     * 本对象的源码是编辑后的文本，tokens 是编辑前文本的 tokenize() 结果（以EOF Token结尾）。
+     * 只从编辑位置之前最近的一个换行Token之后开始重新分析，直到新Token在编辑之后的位置上
+     * 与旧Token重新对齐（此后的输入相同、词法分析器状态相同，结果必然相同），
+     * 然后就地替换中间的Token，并平移之后Token的偏移和行号。
+     * VIEW 模式下所有不持有值的Token都会重新指向本对象的源码。
+     * 重新分析的代价只与编辑所在的行和受影响的Token有关，但之后的Token要逐个平移，
+     * 每次编辑仍是 O(n)（百万个Token约数毫秒）；频繁编辑的大文件应使用 SegmentedTokens 版本。
+     * 之前的Token只在源码缓冲区换了位置时才重新指向新源码。
+     * @param tokens 编辑前的Token列表，就地更新为编辑后的结果
+     * @param edit 编辑范围
+     * @return 被替换的Token范围，便于调用者只更新受影响的部分（如语法高亮）
+     * @throws LexicalException 编辑后的文本有词法错误（此时 tokens 保持不变）；
+     *         恢复模式下错误作为 ILLEGAL Token 替换进去，诊断信息只包含重新分析的部分
+     */
+    TokenSplice retokenize(std::vector<Token>& tokens, const TextEdit& edit);
+
+    /**
+     * 获取所有Token并分段保存，供之后用 retokenize(SegmentedTokens&, ...) 增量更新
+     * VIEW 模式下Token引用词法分析器的源码
+     * @param tokens 输出列表，原有内容会被清空
+     */
+    void tokenizeInto(SegmentedTokens& tokens);
+
+    /**
+     * 增量重新分析分段保存的Token，结果与 std::vector 版本相同
+     * 只重建编辑涉及的段，之后的段只记录待应用的偏移和行号增量，
+     * 每次编辑的代价与受影响的Token数和段数（Token数 / SEGMENT_SIZE）成正比
+     * @param tokens 编辑前由 tokenizeInto(SegmentedTokens&) 或本函数得到的Token，就地更新
+     * @param edit 编辑范围
+     * @return 被替换的Token范围
+     * @throws LexicalException 编辑后的文本有词法错误（此时 tokens 保持不变）
+     */
+    TokenSplice retokenize(SegmentedTokens& tokens, const TextEdit& edit);
+
+    /**
+     * 获取恢复模式下已记录的诊断信息
+     */
+    [[nodiscard]] const std::vector<Diagnostic>& getDiagnostics() const { return diagnostics_; }
+
+    /**
+     * 重置词法分析器到起始位置，同时清空诊断信息
      */
     void reset();
 
     /**
      * 获取当前行号
      */
-    [[nodiscard]] int getCurrentLine() const { return line_; }
+    [[nodiscard]] int getCurrentLine() const;
 
     /**
      * 获取当前列号
      */
-    [[nodiscard]] int getCurrentColumn() const { return column_; }
+    [[nodiscard]] int getCurrentColumn() const;
+
+    /**
+     * 获取源码中某个偏移所在的行号
+     * 首次调用时建立换行符索引，之后每次查询为二分查找
+     * @param offset 字节偏移（例如 Token::getOffset()）
+     * @return 从 1 开始的行号
+     */
+    [[nodiscard]] int lineOf(size_t offset) const;
+
+    /**
+     * 获取源码中某个偏移所在的列号
+     * @param offset 字节偏移
+     * @return 从 1 开始的列号（按字节计）
+     */
+    [[nodiscard]] int columnOf(size_t offset) const;
 
     /**
      * 检查是否到达文件末尾
@@ -57,19 +335,97 @@ public:
     [[nodiscard]] bool isAtEnd() const { return index_ >= source_code_.length(); }
 
 private:
-    std::string source_code_;
+    // 流式分析在滑动窗口上复用本类，需要设置窗口的起始位置
+    friend class StreamLexer;
+
+    struct BorrowedSource {};
+
+    // 累加指数时的上限：指数的绝对值超过它的数字必然上溢或下溢，不必精确累加
+    static constexpr int64_t EXPONENT_LIMIT = 1000000000;
+
+    /**
+     * 借用外部源码的构造函数，见 borrowed()
+     */
+    Lexical(std::string_view source_code, LexerOptions options, BorrowedSource);
+
+    /**
+     * 跳转到指定位置
+     * 调用者需保证该位置是Token边界，且 line 是该位置的行号
+     */
+    void seek(size_t index, int line);
+
+    /**
+     * 一次编辑的重新分析结果：用 fresh 替换旧列表中 [first, resync) 的Token，
+     * 之后的Token平移 delta 个字节、line_delta 行
+     */
+    struct Relexed {
+        size_t first = 0;
+        size_t resync = 0;
+        std::ptrdiff_t delta = 0;
+        int line_delta = 0;
+        std::vector<Token> fresh;
+    };
+
+    /**
+     * retokenize 的公共部分：从编辑前最近的换行Token之后重新分析，直到与旧Token对齐
+     * OldTokens 提供 size/offsetAt/lineAt/typeAt/lowerBound，返回编辑后文本中的位置
+     */
+    template <typename OldTokens>
+    Relexed relexEdit(const OldTokens& tokens, const TextEdit& edit);
+
+    /**
+     * 采用并行推测分析产生的Token：推测分析不驻留标识符，这里按串行顺序驻留，使符号 ID 与 tokenize() 相同
+     */
+    void adoptSpeculative(Token& token) const;
+
+    // 持有的源码，借用外部源码时为空
+    std::string owned_source_;
+    std::string_view source_code_;
+    LexerOptions options_;
     size_t index_;
+    // 当前Token在源码中的起始位置
+    size_t token_start_;
     int line_;
-    int column_;
+    // 当前行第一个字符的偏移，列号由 index_ - line_start_ 得出
+    size_t line_start_;
+    // 当前Token起始处的行号和该行的起始偏移，Token记录的是起始行，与 lineOf(getOffset()) 一致
+    int token_line_ = 1;
+    size_t token_line_start_ = 0;
+    // 换行符偏移的有序索引，供 lineOf/columnOf 按需建立
+    mutable std::vector<size_t> newline_index_;
+    mutable bool newline_index_built_ = false;
+    // Token偏移的基准，流式分析时为窗口在整个输入中的偏移
+    size_t base_offset_ = 0;
+    // 恢复模式下记录的诊断信息
+    std::vector<Diagnostic> diagnostics_;
+    // 达到 max_errors 后不再分析，之后只返回EOF Token
+    bool stopped_ = false;
+    // 解码字面量的缓冲区，跨Token复用容量
+    std::string decoded_;
+    // 不为空时解码后的值分配在这里，Token不持有值
+    std::pmr::memory_resource* value_resource_ = nullptr;
+    // scan() 期间不需要Token的值：含转义的字面量直接引用源码，标识符不驻留
+    bool discard_values_ = false;
+
+    /**
+     * 扫描下一个Token，值总是引用源码（含转义的字面量除外）
+     */
+    Token scanToken();
+
+    /**
+     * switch 后端的扫描实现
+     */
+    Token scanTokenSwitch();
 
-    // 静态查找表
-    static std::unordered_set<std::string> keywords_;
-    static bool initialized_;
+    /**
+     * 表驱动后端的扫描实现（lexical_table.cpp）
+     */
+    Token scanTokenTable();
 
     /**
-     * 初始化静态数据
+     * 表驱动后端读取数字，扫描数字的同时累加出它的值
      */
-    static void initializeStatic();
+    Token readNumberTable();
 
     /**
      * 获取当前字符
@@ -86,6 +442,35 @@ private:
      */
     void advance();
 
+    /**
+     * 前进到指定位置，调用者需保证途中没有换行符
+     */
+    void advanceTo(size_t index);
+
+    /**
+     * 前进到指定位置，途中的 newlines 个换行符一次性计入行号
+     */
+    void advanceAcross(size_t index, size_t newlines);
+
+    /**
+     * 建立换行符索引
+     */
+    void buildNewlineIndex() const;
+
+    /**
+     * 在当前位置开始一个Token，记下起始位置和起始行
+     */
+    void beginToken() {
+        token_start_ = index_;
+        token_line_ = line_;
+        token_line_start_ = line_start_;
+    }
+
+    /**
+     * 当前Token应记录的行号（起始行），不维护行号时为 0
+     */
+    [[nodiscard]] int tokenLine() const { return options_.track_positions ? token_line_ : 0; }
+
     /**
      * 跳过空白字符
      */
@@ -98,8 +483,9 @@ private:
 
     /**
      * 跳过多行注释
+     * @return 注释是否正常结束（恢复模式下未结束的注释一直跳到文件末尾）
      */
-    void skipMultiLineComment();
+    bool skipMultiLineComment();
 
     /**
      * 读取标识符或关键字
@@ -107,7 +493,7 @@ private:
     Token readIdentifierOrKeyword();
 
     /**
-     * 读取数字
+     * 读取数字，扫描数字的同时累加出它的值
      */
     Token readNumber();
 
@@ -147,20 +533,72 @@ private:
     static bool isAlphaNumeric(char c);
 
     /**
-     * 检查字符串是否为关键字
+     * 创建Token，值为源码中从 token_start_ 到当前位置的文本
+     */
+    [[nodiscard]] Token makeToken(TokenType type) const;
+
+    /**
+     * 创建标识符或关键字Token，启用驻留表时为标识符记录符号 ID
+     */
+    [[nodiscard]] Token makeWordToken(TokenType type) const;
+
+    /**
+     * 创建Token，值为源码中的一段文本
+     */
+    [[nodiscard]] Token makeToken(TokenType type, std::string_view value) const;
+
+    /**
+     * 创建持有解码后值副本的Token（用于含转义的字面量）
+     * 设置了 value_resource_ 时值拷贝到内存资源中，Token只引用它
+     */
+    [[nodiscard]] Token makeDecodedToken(TokenType type, std::string_view value) const;
+
+    /**
+     * 创建整数Token（从 token_start_ 到当前位置）
+     * @param value 扫描时累加出的值
+     * @param overflow 累加过程中是否超出 int64 范围，超出时报告错误并返回 ILLEGAL Token
+     */
+    [[nodiscard]] Token makeIntegerToken(uint64_t value, bool overflow);
+
+    /**
+     * 创建十进制数字Token（从 token_start_ 到当前位置）
+     * @param mantissa 全部数字（不含小数点）按十进制累加的结果，超过 19 位有效数字时已回绕
+     * @param digits 有效数字（第一个非零数字起）的个数
+     * @param exponent 小数位数和指数部分合起来的十的幂
+     * @param is_float 是否有小数部分或指数部分
+     */
+    [[nodiscard]] Token makeDecimalToken(uint64_t mantissa, size_t digits, int64_t exponent, bool is_float);
+
+    /**
+     * 把值拷贝到内存资源中，返回引用它的视图
+     */
+    static std::string_view storeValue(std::pmr::memory_resource* resource, std::string_view value);
+
+    /**
+     * 报告当前位置的词法错误：默认抛出 LexicalException，恢复模式下记录诊断信息后返回，
+     * 由调用者产生 ILLEGAL Token 并越过出错的文本
+     */
+    void reportError(LexicalErrorCode code, char error_char);
+
+    /**
+     * 报告指定位置的词法错误，位置不能早于当前行的行首
+     */
+    void reportErrorAt(size_t position, LexicalErrorCode code, char error_char);
+
+    /**
+     * 是否按恢复模式处理词法错误
      */
-    static bool isKeyword(const std::string& text);
+    [[nodiscard]] bool recovering() const { return !DREAMLANG_HAS_EXCEPTIONS || options_.recover_errors; }
 
     /**
-     * 创建Token
+     * 越过不能开始任何Token的字符（连同其后的 UTF-8 后续字节）
      */
-    [[nodiscard]] Token makeToken(TokenType type, const std::string& value = "") const;
+    void skipIllegalCharacter();
 
     /**
-     * 抛出词法错误
+     * 越过畸形数字之后紧跟的字母数字，把整个单词作为一个 ILLEGAL Token
      */
-    void throwError(const std::string& error_type, char error_char, 
-                   const std::string& token_type) const;
+    Token recoverIllegalWord();
 };
 
 } // namespace dreamlang::lexer
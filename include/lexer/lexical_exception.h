@@ -1,5 +1,6 @@
 #pragma once
 
+#include "diagnostic.h"
 #include <stdexcept>
 #include <string>
 
@@ -32,6 +33,12 @@ public:
      */
     LexicalException(const std::string& message, int line, int column = -1);
 
+    /**
+     * 构造函数（由诊断信息生成，错误消息按当前语言翻译）
+     * @param diagnostic 诊断信息
+     */
+    explicit LexicalException(const Diagnostic& diagnostic);
+
     /**
      * 获取错误类型
      */
@@ -70,9 +77,13 @@ private:
     int column_;
 
     /**
-     * 生成错误消息
+     * 生成错误消息（在基类构造时调用，此时成员尚未初始化，因此使用参数）
      */
-    std::string generateMessage() const;
+    static std::string generateMessage(const std::string& error_type,
+                                       char error_char,
+                                       const std::string& error_token_type,
+                                       int line,
+                                       int column);
 };
 
 } // namespace dreamlang::lexer
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace dreamlang::lexer {
+
+/**
+ * 带缓冲的输出目标
+ *
+ * 输出先追加到固定大小的缓冲区，缓冲区满时整块写入目标（流、文件描述符或字符串），
+ * 因此无论输出多大内存占用都不变，也避免了逐个字符经过流的格式化和加锁。析构时写出剩余内容。
+ */
+class OutputBuffer {
+public:
+    /**
+     * 默认缓冲区大小
+     */
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+
+    /**
+     * 构造函数
+     * @param out 目标流，需比缓冲区活得更久
+     * @param capacity 缓冲区大小
+     */
+    explicit OutputBuffer(std::ostream& out, size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * 构造函数，缓冲区满时用一次 write(2) 写入文件描述符
+     * @param fd 文件描述符，不会被关闭
+     * @param capacity 缓冲区大小
+     */
+    explicit OutputBuffer(int fd, size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * 构造函数，缓冲区满时追加到字符串末尾
+     * @param out 目标字符串，需比缓冲区活得更久
+     * @param capacity 缓冲区大小
+     */
+    explicit OutputBuffer(std::string& out, size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * 析构函数，写出剩余内容
+     */
+    ~OutputBuffer();
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    /**
+     * 追加一个字符
+     */
+    void put(char c) {
+        if (size_ == capacity_) {
+            flush();
+        }
+        data_[size_++] = c;
+    }
+
+    /**
+     * 追加一段文本
+     */
+    void write(std::string_view text) {
+        if (text.size() <= capacity_ - size_) {
+            std::memcpy(data_.get() + size_, text.data(), text.size());
+            size_ += text.size();
+        } else {
+            writeLarge(text);
+        }
+    }
+
+    /**
+     * 以十进制追加一个整数
+     */
+    void writeInteger(int64_t value);
+
+    /**
+     * 追加 count 个相同的字符
+     */
+    void fill(char c, size_t count);
+
+    /**
+     * 把缓冲区中的内容写入目标
+     */
+    void flush();
+
+    /**
+     * 检查写入目标时是否出错
+     */
+    [[nodiscard]] bool good() const { return stream_ != nullptr ? stream_->good() : !failed_; }
+
+private:
+    /**
+     * 写入放不进缓冲区剩余空间的文本
+     */
+    void writeLarge(std::string_view text);
+
+    /**
+     * 把一段数据写入目标
+     */
+    void writeTarget(const char* data, size_t size);
+
+    // 三种目标只有一种有效
+    std::ostream* stream_ = nullptr;
+    std::string* string_ = nullptr;
+    int fd_ = -1;
+    bool failed_ = false;
+    std::unique_ptr<char[]> data_;
+    size_t capacity_;
+    size_t size_ = 0;
+};
+
+} // namespace dreamlang::lexer
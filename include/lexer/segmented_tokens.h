@@ -0,0 +1,111 @@
+#pragma once
+
+#include "token.h"
+#include "token_type.h"
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace dreamlang::lexer {
+
+/**
+ * 分段保存的Token列表，供频繁编辑的大文件做增量分析（见 Lexical::retokenize）
+ *
+ * Token按顺序分成若干段，每段约 SEGMENT_SIZE 个。编辑时只重建编辑涉及的段，之后的段只累加一个
+ * 待应用的偏移和行号增量；VIEW 模式下不持有值的Token也不立即重新指向新源码。
+ * 因此一次编辑只改写受影响的Token，其余部分的代价是每段一次整数加法（百万个Token约一千段），
+ * 而不是逐个平移其后的全部Token。某段被访问时才一次性应用积累的增量。
+ */
+class SegmentedTokens {
+public:
+    /**
+     * 每段的目标Token数
+     */
+    static constexpr size_t SEGMENT_SIZE = 1024;
+
+    SegmentedTokens() = default;
+
+    /**
+     * 获取Token数量
+     */
+    [[nodiscard]] size_t size() const { return size_; }
+
+    /**
+     * 检查是否为空
+     */
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+
+    /**
+     * 获取段数
+     */
+    [[nodiscard]] size_t segmentCount() const { return segments_.size(); }
+
+    /**
+     * 获取第 index 个Token，首次访问编辑后的段时应用积累的增量
+     * 顺序访问时只在跨段时查找段，引用在下一次编辑前有效
+     */
+    const Token& operator[](size_t index);
+
+    /**
+     * 拷贝出全部Token
+     */
+    std::vector<Token> toVector();
+
+private:
+    // 由 Lexical::tokenizeInto 填充、由 Lexical::retokenize 更新
+    friend class Lexical;
+
+    struct Segment {
+        std::vector<Token> tokens;
+        // 段中第一个Token在整个列表中的下标
+        size_t first_index = 0;
+        // 尚未应用到 tokens 的偏移和行号增量
+        std::ptrdiff_t offset_delta = 0;
+        int line_delta = 0;
+        // tokens 中不持有值的Token当前指向的源码
+        const char* bound_source = nullptr;
+    };
+
+    /**
+     * 用完整的Token列表重建全部段
+     * @param rebind Token的值是否指向源码（VIEW 模式），编辑后需要重新指向新源码
+     */
+    void assign(std::vector<Token> tokens, std::string_view source, bool rebind);
+
+    /**
+     * 查找包含第 index 个Token的段
+     */
+    size_t segmentOf(size_t index) const;
+
+    /**
+     * 应用段上积累的增量，使其中的Token都指向当前源码
+     */
+    void settle(Segment& segment);
+
+    // 以下查询不应用增量，只计算编辑后的位置，供增量分析定位编辑范围
+
+    [[nodiscard]] size_t offsetAt(size_t index) const;
+    [[nodiscard]] int lineAt(size_t index) const;
+    [[nodiscard]] TokenType typeAt(size_t index) const;
+
+    /**
+     * 获取第一个偏移不小于 offset 的Token的下标
+     */
+    [[nodiscard]] size_t lowerBound(size_t offset) const;
+
+    /**
+     * 用 fresh 替换 [first, resync) 的Token，之后的Token平移 delta 个字节、line_delta 行
+     * @param source 编辑后的源码
+     */
+    void splice(size_t first, size_t resync, std::vector<Token>&& fresh, std::ptrdiff_t delta, int line_delta,
+                std::string_view source);
+
+    std::vector<Segment> segments_;
+    size_t size_ = 0;
+    std::string_view source_;
+    bool rebind_ = false;
+    // 上一次访问的段，顺序访问时不必二分查找
+    mutable size_t last_segment_ = 0;
+};
+
+} // namespace dreamlang::lexer
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+namespace dreamlang::lexer::simd {
+
+/**
+ * 词法分析器的批量字符扫描例程
+ *
+ * 在 x86-64 上以 SSE2 为基线，运行时检测到 AVX2 时使用 AVX2，
+ * 其他平台使用逐字节的标量实现。所有函数只读取 [begin, end) 范围内的字节。
+ */
+
+/**
+ * 跳过空格、制表符和回车（换行符是单独的Token，不会被跳过）
+ * @return 第一个非空白字符的位置，全部是空白时返回 end
+ */
+const char* skipBlanks(const char* begin, const char* end);
+
+/**
+ * 查找第一个换行符
+ * @return 换行符的位置，找不到时返回 end
+ */
+const char* findNewline(const char* begin, const char* end);
+
+/**
+ * 查找多行注释的结束标记 "*" "/"
+ * @param newlines 累加 [begin, 返回值) 中的换行符数量
+ * @return 结束标记中 '*' 的位置，找不到时返回 end
+ */
+const char* findCommentEnd(const char* begin, const char* end, size_t& newlines);
+
+/**
+ * 查找字符串字面量中第一个需要特殊处理的字符：双引号、反斜杠或回车
+ * @param newlines 累加 [begin, 返回值) 中的换行符数量
+ * @return 该字符的位置，找不到时返回 end
+ */
+const char* findStringSpecial(const char* begin, const char* end, size_t& newlines);
+
+/**
+ * 统计 [begin, end) 中的换行符数量
+ */
+size_t countNewlines(const char* begin, const char* end);
+
+/**
+ * 获取当前选用的实现名称（"avx2"、"sse2" 或 "scalar"）
+ */
+const char* implementationName();
+
+} // namespace dreamlang::lexer::simd
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace dreamlang::lexer {
+
+/**
+ * 只读的源文件缓冲区
+ *
+ * 普通文件以只读方式映射到内存（预读整个文件并提示顺序访问），不做任何拷贝和改写；
+ * 管道等无法映射的输入以及非 POSIX 平台退化为一次性读入。
+ * 无论哪种方式，view() 之后的一个字节都保证可读且为 '\0'，可直接交给 Lexical::borrowed。
+ * 映射期间文件被其他进程截断会导致访问出错，这与其他基于 mmap 的工具相同。
+ */
+class SourceBuffer {
+public:
+    SourceBuffer() = default;
+
+    /**
+     * 析构函数，解除映射
+     */
+    ~SourceBuffer();
+
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+    SourceBuffer(SourceBuffer&& other) noexcept;
+    SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+
+    /**
+     * 打开源文件，之前打开的文件会被关闭
+     * @param path 文件路径
+     * @return 是否成功打开（失败时 errno 保留系统错误）
+     */
+    bool open(const std::string& path);
+
+    /**
+     * 关闭文件并释放映射
+     */
+    void close();
+
+    /**
+     * 获取文件内容，在缓冲区关闭或销毁前一直有效
+     */
+    std::string_view view() const { return view_; }
+
+    /**
+     * 获取文件大小
+     */
+    size_t size() const { return view_.size(); }
+
+    /**
+     * 检查内容是否来自内存映射
+     */
+    bool isMapped() const { return mapping_ != nullptr; }
+
+private:
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    // 无法映射时的读入结果，std::string 自带末尾的 '\0'
+    std::string fallback_;
+    std::string_view view_;
+};
+
+} // namespace dreamlang::lexer
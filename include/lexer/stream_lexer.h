@@ -0,0 +1,119 @@
+#pragma once
+
+#include "lexical.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dreamlang::lexer {
+
+/**
+ * 流式词法分析器
+ *
+ * 从文件描述符（包括标准输入和管道）按块读取源码，边读边分析，不需要一次性持有整个输入。
+ * 内部在一个滑动窗口上运行 Lexical：只交出后面至少还有两个字节的Token（运算符和小数点最多向后看两个字符），
+ * 其余部分留到下一块读入后重新分析，因此跨块的字符串、注释和多字符运算符的结果与整体分析完全一致。
+ * 内存占用约为块大小加上最长的单个Token（或注释），与输入总长度无关。
+ *
+ * Token的偏移是整个输入中的 64 位字节偏移；行号仍为 int，可表示 2^31 行。
+ * VIEW 模式下Token的值引用内部窗口，只在下一次调用 nextToken() 之前有效。
+ * 恢复模式（LexerOptions::recover_errors）下词法错误作为 ILLEGAL Token 交出，诊断信息通过 getDiagnostics() 获取。
+ */
+class StreamLexer {
+public:
+    /**
+     * 默认的读取块大小
+     */
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    /**
+     * Token消费者
+     */
+    using Consumer = std::function<void(const Token&)>;
+
+    /**
+     * 构造函数
+     * @param fd 输入文件描述符，由调用者负责关闭
+     * @param options 词法分析器选项（表驱动后端同样适用）
+     * @param block_size 每次 read(2) 的字节数
+     */
+    explicit StreamLexer(int fd, LexerOptions options = {}, size_t block_size = DEFAULT_BLOCK_SIZE);
+
+    StreamLexer(const StreamLexer&) = delete;
+    StreamLexer& operator=(const StreamLexer&) = delete;
+
+    /**
+     * 获取下一个Token
+     * @return 下一个Token，输入结束时返回EOF Token（之后重复返回EOF Token）
+     * @throws LexicalException 词法错误（恢复模式除外），行号和列号相对于整个输入
+     * @throws std::system_error 读取失败
+     */
+    Token nextToken();
+
+    /**
+     * 分析整个输入，每产生一个Token（包括最后的EOF Token）调用一次消费者
+     * @param consumer Token消费者，VIEW 模式下Token只在回调期间有效
+     * @return Token总数（包括EOF Token）
+     */
+    uint64_t run(const Consumer& consumer);
+
+    /**
+     * 获取已读取的字节数
+     */
+    [[nodiscard]] uint64_t bytesRead() const { return bytes_read_; }
+
+    /**
+     * 获取恢复模式下已交出的 ILLEGAL Token 对应的诊断信息，行号、列号和偏移相对于整个输入
+     */
+    [[nodiscard]] const std::vector<Diagnostic>& getDiagnostics() const { return diagnostics_; }
+
+private:
+    /**
+     * 读入更多输入并分析，直到有新的Token可以交出或输入结束
+     */
+    void fill();
+
+    /**
+     * 丢弃窗口中 start_ 之前已经交出的部分
+     */
+    void compact();
+
+    /**
+     * 读取一块输入追加到窗口，返回读到的字节数
+     */
+    size_t readBlock(size_t size);
+
+    /**
+     * 把窗口内分析得到的诊断信息换算为相对于整个输入的行号和列号
+     */
+    Diagnostic rebase(Diagnostic diagnostic) const;
+
+    int fd_;
+    LexerOptions options_;
+    size_t block_size_;
+
+    // 输入中尚未交出的部分，起点总是Token边界
+    std::string window_;
+    // 窗口起点在输入中的偏移、行号和列号
+    uint64_t window_offset_;
+    int window_line_;
+    int window_column_;
+    // 下一次分析的起始位置（窗口内的偏移）
+    size_t start_;
+    bool eof_;
+    bool finished_;
+    uint64_t bytes_read_;
+
+    // 已分析但尚未交出的Token
+    std::vector<Token> pending_;
+    size_t next_;
+    // 词法错误，在之前的Token全部交出后抛出
+    std::optional<Diagnostic> error_;
+    // 恢复模式下的诊断信息
+    std::vector<Diagnostic> diagnostics_;
+};
+
+} // namespace dreamlang::lexer
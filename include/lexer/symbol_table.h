@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace dreamlang::lexer {
+
+/**
+ * 标识符驻留表
+ *
+ * 把每个不同的标识符映射为从 0 开始连续分配的 32 位 ID，文本只保存一份。
+ * 表按哈希值分为若干分片，每个分片有自己的锁和 arena，多个词法分析器（例如并行分析多个文件）
+ * 可以共用同一张表而不争用全局锁；按 ID 取文本不加锁。
+ * ID 按首次插入的顺序分配，多个词法分析器并行插入时顺序取决于线程调度
+ * （单个文件的 Lexical::tokenizeParallel 按串行顺序插入，ID 与 tokenize() 相同）。
+ */
+class SymbolTable {
+public:
+    /**
+     * 表示没有符号的 ID
+     */
+    static constexpr uint32_t NO_SYMBOL = UINT32_MAX;
+
+    SymbolTable();
+
+    /**
+     * 析构函数，释放全部文本
+     */
+    ~SymbolTable();
+
+    // 文本视图指向表内部，禁止拷贝和移动
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    /**
+     * 查找或插入标识符（线程安全）
+     * @param name 标识符文本
+     * @return 标识符的 ID
+     */
+    uint32_t intern(std::string_view name);
+
+    /**
+     * 获取 ID 对应的文本（线程安全），在表销毁前有效
+     * @param id intern() 返回过的 ID
+     */
+    std::string_view text(uint32_t id) const;
+
+    /**
+     * 获取已分配的 ID 数量
+     */
+    size_t size() const { return next_id_.load(std::memory_order_acquire); }
+
+private:
+    // 分片数（2 的幂），由哈希值的高位选择
+    static constexpr unsigned SHARD_BITS = 6;
+    static constexpr size_t SHARD_COUNT = size_t{1} << SHARD_BITS;
+    // ID 到文本的数组分段保存，第 k 段有 FIRST_SEGMENT_SIZE << k 项，已分配的段不会移动
+    static constexpr unsigned FIRST_SEGMENT_BITS = 10;
+    static constexpr size_t FIRST_SEGMENT_SIZE = size_t{1} << FIRST_SEGMENT_BITS;
+    static constexpr size_t SEGMENT_COUNT = 32 - FIRST_SEGMENT_BITS;
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::pmr::monotonic_buffer_resource arena{4096};
+        // 键指向 arena 中的文本
+        std::unordered_map<std::string_view, uint32_t> ids;
+    };
+
+    /**
+     * 获取保存 ID 文本的位置，必要时分配所在的段
+     */
+    std::string_view* slot(uint32_t id, bool allocate) const;
+
+    Shard shards_[SHARD_COUNT];
+    std::atomic<uint32_t> next_id_;
+    mutable std::atomic<std::string_view*> segments_[SEGMENT_COUNT];
+};
+
+} // namespace dreamlang::lexer
@@ -1,22 +1,48 @@
 #pragma once
 
 #include "token_type.h"
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace dreamlang::lexer {
 
+/**
+ * 数字字面量预先转换出的值的形式
+ */
+enum class NumberForm : uint8_t {
+    // 不是数字字面量（或Token不是由词法分析器产生的）
+    NONE,
+    // 整数（十进制、十六进制、二进制或八进制），值在 int64 范围内
+    INTEGER,
+    // 带小数部分或指数的浮点数
+    FLOAT
+};
+
 /**
  * Token类，表示词法分析的基本单元
  */
 class Token {
 public:
     /**
-     * 构造函数
+     * 构造函数，Token持有值的副本
      * @param type Token类型
      * @param value Token值
      * @param line 行号
+     * @param offset Token在源码中的起始偏移
      */
-    Token(TokenType type, const std::string& value, int line);
+    Token(TokenType type, std::string value, int line, size_t offset = 0);
+
+    /**
+     * 创建不持有值的Token，值指向外部缓冲区（通常是词法分析器的源码）
+     * 调用者需保证缓冲区的生命周期不短于Token
+     * @param type Token类型
+     * @param value Token值的视图
+     * @param line 行号
+     * @param offset Token在源码中的起始偏移
+     */
+    static Token borrowed(TokenType type, std::string_view value, int line, size_t offset = 0);
 
     /**
      * 拷贝构造函数
@@ -41,13 +67,57 @@ public:
     /**
      * 析构函数
      */
-    ~Token() = default;
+    ~Token();
 
     // Getter方法
     TokenType getType() const { return type_; }
-    const std::string& getValue() const { return value_; }
+
+    /**
+     * 获取Token的值
+     * 不持有值时指向外部缓冲区；持有值时指向Token自身，Token被修改、移动或销毁后失效
+     */
+    std::string_view getValue() const {
+        return storage_ == Storage::INLINE ? std::string_view(value_.chars, inline_size_)
+                                           : std::string_view(value_.ref.data, value_.ref.size);
+    }
     int getLine() const { return line_; }
 
+    /**
+     * 获取Token在源码中的起始字节偏移（字符串和字符字面量指向开头的引号）
+     */
+    size_t getOffset() const { return offset_; }
+
+    /**
+     * 获取标识符在 SymbolTable 中的 ID，没有使用驻留表时为 UINT32_MAX（SymbolTable::NO_SYMBOL）
+     * 同一张表中 ID 相等当且仅当名字相等，可以代替字符串比较
+     */
+    uint32_t getSymbol() const { return symbol_; }
+
+    /**
+     * 检查Token是否带有符号 ID
+     */
+    bool hasSymbol() const { return symbol_ != UINT32_MAX; }
+
+    /**
+     * 获取数字字面量的形式，决定 getInteger() 和 getFloat() 中哪个有效
+     */
+    NumberForm getNumberForm() const { return number_form_; }
+
+    /**
+     * 获取整数字面量的值，仅在形式为 INTEGER 时有效
+     */
+    int64_t getInteger() const { return number_.integer; }
+
+    /**
+     * 获取浮点数字面量的值（按 IEEE 754 双精度正确舍入），仅在形式为 FLOAT 时有效
+     */
+    double getFloat() const { return number_.real; }
+
+    /**
+     * 检查Token是否持有自己的值副本
+     */
+    bool ownsValue() const { return storage_ != Storage::BORROWED; }
+
     /**
      * 检查是否是关键字
      */
@@ -69,7 +139,8 @@ public:
     std::string toString() const;
 
     /**
-     * 等于操作符
+     * 等于操作符，比较类型、行号和值
+     * 两个Token都带有符号 ID 时比较 ID 而不是名字，因此它们须来自同一张驻留表
      */
     bool operator==(const Token& other) const;
 
@@ -79,9 +150,79 @@ public:
     bool operator!=(const Token& other) const;
 
 private:
+    // 增量分析需要就地更新已有Token的位置
+    friend class Lexical;
+    friend class SegmentedTokens;
+    // 从二进制缓存还原数字字面量的值
+    friend class TokenCacheReader;
+
+    /**
+     * 值的存储方式
+     */
+    enum class Storage : uint8_t {
+        // 指向外部缓冲区（源码、驻留表或内存资源）
+        BORROWED,
+        // 持有值，不超过 INLINE_CAPACITY 字节的值直接保存在 value_ 中
+        INLINE,
+        // 持有值，保存在单独分配的堆内存中
+        HEAP
+    };
+
+    // 值与引用外部值的指针和长度共用同一块内存
+    static constexpr size_t INLINE_CAPACITY = sizeof(const char*) + sizeof(size_t);
+
+    /**
+     * 构造空值的Token
+     */
+    Token(TokenType type, int line, size_t offset);
+
+    /**
+     * 改为持有 value 的副本（value 可以指向本Token当前的值）
+     */
+    void assignOwned(std::string_view value);
+
+    /**
+     * 改为引用外部的 value，释放原来持有的值
+     */
+    void assignBorrowed(std::string_view value);
+
+    /**
+     * 释放持有的堆内存
+     */
+    void release();
+
+    /**
+     * 源码编辑后平移Token的位置
+     * @param delta 偏移的增量
+     * @param line_delta 行号的增量
+     * @param source 编辑后的源码
+     * @param rebind 为 true 时不持有值的Token重新指向 source 中对应的文本（字符串和字符字面量跳过开头的引号）
+     */
+    void shift(std::ptrdiff_t delta, int line_delta, std::string_view source, bool rebind);
+
     TokenType type_;
-    std::string value_;
+    // 标识符的符号 ID，放在 type_ 之后的填充位置，不增加Token的大小
+    uint32_t symbol_ = UINT32_MAX;
+    // 按 storage_ 区分：BORROWED 和 HEAP 时是指针和长度，INLINE 时是值本身
+    // 不在每个Token中嵌入 std::string，VIEW 模式的Token不为用不到的存储付出空间
+    union Value {
+        struct {
+            const char* data;
+            size_t size;
+        } ref;
+        char chars[INLINE_CAPACITY];
+    } value_{};
     int line_;
+    Storage storage_ = Storage::BORROWED;
+    NumberForm number_form_ = NumberForm::NONE;
+    // INLINE 时值的长度
+    uint8_t inline_size_ = 0;
+    size_t offset_;
+    // 数字字面量的值；line_、storage_、number_form_ 和 inline_size_ 挤在同一个 8 字节中
+    union {
+        int64_t integer;
+        double real;
+    } number_{};
 };
 
 } // namespace dreamlang::lexer
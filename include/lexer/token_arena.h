@@ -0,0 +1,71 @@
+#pragma once
+
+#include "token.h"
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace dreamlang::lexer {
+
+/**
+ * 基于 arena 的Token列表
+ *
+ * Token数组和Token的值（OWNED 模式下的全部值、VIEW 模式下含转义的字面量）都从同一个
+ * 单调增长的内存资源中分配，分析过程中不再逐个Token调用 malloc，也不会在多个词法分析器
+ * 并行时争用分配器的锁。其中的Token都不持有值（ownsValue() 为 false），
+ * 值在 clear() 或 arena 销毁前有效；clear() 一次性释放全部内存。
+ */
+class TokenArena {
+public:
+    /**
+     * 构造函数
+     * @param initial_size 第一块内存的字节数，之后按几何级数增长
+     */
+    explicit TokenArena(size_t initial_size = 64 * 1024);
+
+    /**
+     * 析构函数，先销毁Token再释放内存
+     */
+    ~TokenArena();
+
+    // Token的值指向 arena 内部，禁止拷贝和移动
+    TokenArena(const TokenArena&) = delete;
+    TokenArena& operator=(const TokenArena&) = delete;
+
+    /**
+     * 获取Token列表
+     */
+    const std::pmr::vector<Token>& tokens() const { return tokens_; }
+
+    /**
+     * 获取Token数量
+     */
+    size_t size() const { return tokens_.size(); }
+
+    /**
+     * 检查是否为空
+     */
+    bool empty() const { return tokens_.empty(); }
+
+    std::pmr::vector<Token>::const_iterator begin() const { return tokens_.begin(); }
+    std::pmr::vector<Token>::const_iterator end() const { return tokens_.end(); }
+    const Token& operator[](size_t index) const { return tokens_[index]; }
+
+    /**
+     * 获取 arena 的内存资源，可用于分配与Token同生命周期的其他数据
+     */
+    std::pmr::memory_resource* resource() { return &resource_; }
+
+    /**
+     * 清空Token并一次性释放 arena 中的全部内存
+     */
+    void clear();
+
+private:
+    friend class Lexical;
+
+    std::pmr::monotonic_buffer_resource resource_;
+    std::pmr::vector<Token> tokens_;
+};
+
+} // namespace dreamlang::lexer
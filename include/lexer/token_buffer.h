@@ -0,0 +1,181 @@
+#pragma once
+
+#include "token_type.h"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dreamlang::lexer {
+
+/**
+ * 列式（struct-of-arrays）Token缓冲区
+ *
+ * 每个Token只保存 1 字节类型、4 字节偏移和 4 字节长度，行号按行压缩保存，
+ * 值通过偏移和长度引用源码。含转义的字面量的解码结果保存在独立的字符串池中。
+ * 缓冲区引用填充它的词法分析器的源码，不能比词法分析器活得更久。
+ */
+class TokenBuffer {
+public:
+    /**
+     * 缓冲区中单个Token的只读视图，接口与Token保持一致
+     */
+    class View {
+    public:
+        View(const TokenBuffer* buffer, size_t index) : buffer_(buffer), index_(index) {}
+
+        TokenType getType() const { return buffer_->type(index_); }
+        std::string_view getValue() const { return buffer_->value(index_); }
+        int getLine() const { return buffer_->line(index_); }
+
+        /**
+         * 获取Token在缓冲区中的下标
+         */
+        size_t index() const { return index_; }
+
+    private:
+        const TokenBuffer* buffer_;
+        size_t index_;
+    };
+
+    /**
+     * 顺序访问缓冲区的迭代器
+     */
+    class Iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = View;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = View;
+
+        Iterator(const TokenBuffer* buffer, size_t index) : buffer_(buffer), index_(index) {}
+
+        View operator*() const { return {buffer_, index_}; }
+        View operator[](difference_type n) const { return {buffer_, index_ + n}; }
+
+        Iterator& operator++() { ++index_; return *this; }
+        Iterator operator++(int) { Iterator old = *this; ++index_; return old; }
+        Iterator& operator--() { --index_; return *this; }
+        Iterator operator--(int) { Iterator old = *this; --index_; return old; }
+        Iterator& operator+=(difference_type n) { index_ += n; return *this; }
+        Iterator& operator-=(difference_type n) { index_ -= n; return *this; }
+        Iterator operator+(difference_type n) const { return {buffer_, index_ + n}; }
+        Iterator operator-(difference_type n) const { return {buffer_, index_ - n}; }
+        difference_type operator-(const Iterator& other) const {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+
+        bool operator==(const Iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const Iterator& other) const { return index_ != other.index_; }
+        bool operator<(const Iterator& other) const { return index_ < other.index_; }
+        bool operator>(const Iterator& other) const { return index_ > other.index_; }
+        bool operator<=(const Iterator& other) const { return index_ <= other.index_; }
+        bool operator>=(const Iterator& other) const { return index_ >= other.index_; }
+
+    private:
+        const TokenBuffer* buffer_;
+        size_t index_;
+    };
+
+    TokenBuffer() = default;
+
+    /**
+     * 获取Token数量
+     */
+    size_t size() const { return types_.size(); }
+
+    /**
+     * 检查缓冲区是否为空
+     */
+    bool empty() const { return types_.empty(); }
+
+    Iterator begin() const { return {this, 0}; }
+    Iterator end() const { return {this, size()}; }
+    View operator[](size_t index) const { return {this, index}; }
+
+    /**
+     * 获取第 index 个Token的类型
+     */
+    TokenType type(size_t index) const { return static_cast<TokenType>(types_[index]); }
+
+    /**
+     * 获取第 index 个Token的值
+     */
+    std::string_view value(size_t index) const;
+
+    /**
+     * 获取第 index 个Token的行号
+     */
+    int line(size_t index) const;
+
+    /**
+     * 获取第 index 个Token的值在源码中的偏移
+     * 对含转义的字面量，偏移和长度指向源码中未解码的文本
+     */
+    uint32_t offset(size_t index) const { return offsets_[index]; }
+
+    /**
+     * 获取第 index 个Token的值在源码中的长度
+     */
+    uint32_t length(size_t index) const { return lengths_[index]; }
+
+    /**
+     * 获取类型数组，便于只关心类型的遍历顺序扫描
+     */
+    const std::vector<uint8_t>& types() const { return types_; }
+
+    /**
+     * 获取缓冲区引用的源码
+     */
+    std::string_view source() const { return source_; }
+
+    /**
+     * 预留空间
+     * @param count 预计的Token数量
+     */
+    void reserve(size_t count);
+
+    /**
+     * 清空缓冲区（保留已分配的空间）
+     */
+    void clear();
+
+    /**
+     * 获取缓冲区占用的堆内存字节数
+     */
+    size_t memoryUsage() const;
+
+private:
+    friend class Lexical;
+
+    /**
+     * 设置引用的源码并清空原有内容
+     */
+    void attach(std::string_view source);
+
+    /**
+     * 追加一个值位于源码中的Token
+     */
+    void append(TokenType type, size_t offset, size_t length, int line);
+
+    /**
+     * 追加一个持有解码后值的Token
+     */
+    void appendDecoded(TokenType type, size_t offset, size_t length, std::string_view decoded, int line);
+
+    std::string_view source_;
+    std::vector<uint8_t> types_;
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> lengths_;
+    // 行号游程：(该行第一个Token的下标, 行号)，只在行号变化时追加
+    std::vector<std::pair<uint32_t, uint32_t>> line_runs_;
+    // 解码字面量：(Token下标, 在 decoded_pool_ 中的偏移)，按下标递增
+    std::vector<std::pair<uint32_t, uint32_t>> decoded_index_;
+    std::string decoded_pool_;
+};
+
+} // namespace dreamlang::lexer
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "lexical.h"
+#include "source_buffer.h"
+#include "token.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dreamlang::lexer {
+
+/**
+ * 二进制Token缓存文件格式的版本，布局或语义变化时递增
+ * 2：文件头记录词法分析结果的版本和选项，记录的类型和数字形式在打开时校验
+ */
+constexpr uint32_t TOKEN_CACHE_VERSION = 2;
+
+/**
+ * 文件头 lexer_options 中的位：生成缓存时影响Token列表的词法分析选项
+ */
+constexpr uint32_t TOKEN_CACHE_TRACK_POSITIONS = 0x01;
+constexpr uint32_t TOKEN_CACHE_RECOVER_ERRORS = 0x02;
+
+/**
+ * 二进制Token缓存文件的扩展名
+ */
+constexpr const char* TOKEN_CACHE_EXTENSION = ".dltok";
+
+/**
+ * 缓存文件头（64 字节）
+ *
+ * 文件布局依次为：文件头、token_count 条 TokenRecord、字符串池。
+ * 所有整数按写入平台的字节序保存，各部分按 8 字节对齐，映射到内存后记录数组可以直接使用，无需解析。
+ */
+struct TokenCacheHeader {
+    // 固定为 "DLTOKENS"
+    char magic[8];
+    uint32_t version;
+    // 写入时为 0x01020304，读取时据此拒绝字节序不同的文件
+    uint32_t byte_order;
+    // 源码的内容哈希（见 contentHash）和长度，二者都一致时缓存有效
+    uint64_t source_hash;
+    uint64_t source_size;
+    uint64_t token_count;
+    // 字符串池在文件中的偏移和长度
+    uint64_t pool_offset;
+    uint64_t pool_size;
+    // 生成缓存的词法分析器的 LEXER_OUTPUT_VERSION，与当前版本不同的文件不能打开
+    uint32_t lexer_version;
+    // TOKEN_CACHE_TRACK_POSITIONS 等选项位，见 tokenCacheOptions()
+    uint32_t lexer_options;
+};
+
+/**
+ * 记录的值保存在字符串池中（含转义的字面量），否则值是源码中的一段文本
+ */
+constexpr uint8_t TOKEN_RECORD_POOLED = 0x01;
+
+/**
+ * 单个Token的定长记录（32 字节）
+ */
+struct TokenRecord {
+    // Token在源码中的起始偏移
+    uint64_t offset;
+    uint32_t line;
+    // TokenType
+    uint8_t type;
+    // NumberForm
+    uint8_t number_form;
+    // TOKEN_RECORD_POOLED 等标志
+    uint8_t flags;
+    uint8_t reserved;
+    // 值在字符串池中的偏移；值在源码中时为相对 offset 的偏移（字面量跳过开头的引号）
+    uint32_t value_offset;
+    uint32_t value_length;
+    // 数字字面量的值，由 number_form 决定哪个成员有效
+    union {
+        int64_t integer;
+        double real;
+    } number;
+};
+
+static_assert(sizeof(TokenCacheHeader) == 64, "TokenCacheHeader must be 64 bytes");
+static_assert(sizeof(TokenRecord) == 32, "TokenRecord must be 32 bytes");
+
+/**
+ * 获取词法分析选项中影响Token列表的部分（行号是否记录、错误是否作为 ILLEGAL Token 返回）
+ * 值的存储方式、后端和驻留表不改变Token列表，不在其中
+ */
+uint32_t tokenCacheOptions(const LexerOptions& options);
+
+/**
+ * 把Token列表编码为二进制缓存文件的内容
+ * @param tokens Token列表，值与源码中的文本相同的Token只记录位置，其余的值（解码后的字面量）写入字符串池
+ * @param source Token所属的源码
+ * @param options 产生 tokens 的词法分析选项
+ * @return 文件内容
+ */
+std::string encodeTokenCache(const std::vector<Token>& tokens, std::string_view source, const LexerOptions& options);
+
+/**
+ * 二进制Token缓存文件的读取器
+ *
+ * 文件映射到内存后检查文件头、各部分的边界和每条记录的类型，记录数组原地使用。
+ * 值在源码中的记录需要对应的源码才能取值，使用前应先用 matches() 确认源码和词法分析选项都没有变化。
+ */
+class TokenCacheReader {
+public:
+    TokenCacheReader() = default;
+
+    TokenCacheReader(const TokenCacheReader&) = delete;
+    TokenCacheReader& operator=(const TokenCacheReader&) = delete;
+
+    /**
+     * 打开缓存文件，之前打开的文件会被关闭
+     * @param path 文件路径
+     * @return 文件存在，格式、版本（包括词法分析结果的版本）和字节序都匹配，且记录有效时返回 true
+     */
+    bool open(const std::string& path);
+
+    /**
+     * 关闭文件
+     */
+    void close();
+
+    /**
+     * 检查缓存是否对应这份源码和这组词法分析选项（比较长度、内容哈希和 tokenCacheOptions()）
+     */
+    [[nodiscard]] bool matches(std::string_view source, const LexerOptions& options) const;
+
+    /**
+     * 获取文件头，仅在 open() 成功后有效
+     */
+    [[nodiscard]] const TokenCacheHeader& header() const { return *header_; }
+
+    /**
+     * 获取Token数量
+     */
+    [[nodiscard]] size_t size() const { return header_ ? header_->token_count : 0; }
+
+    const TokenRecord* begin() const { return records_; }
+    const TokenRecord* end() const { return records_ + size(); }
+    const TokenRecord& operator[](size_t index) const { return records_[index]; }
+
+    /**
+     * 获取记录的值
+     * @param record 本文件中的记录
+     * @param source matches() 为 true 的源码
+     * @return 值的视图（指向文件映射或源码）；记录越界时为空
+     */
+    [[nodiscard]] std::string_view value(const TokenRecord& record, std::string_view source) const;
+
+    /**
+     * 把第 index 条记录还原为不持有值的Token，值的生命周期同 value()
+     */
+    [[nodiscard]] Token token(size_t index, std::string_view source) const;
+
+    /**
+     * 把全部记录还原为Token列表
+     */
+    [[nodiscard]] std::vector<Token> tokens(std::string_view source) const;
+
+private:
+    SourceBuffer file_;
+    const TokenCacheHeader* header_ = nullptr;
+    const TokenRecord* records_ = nullptr;
+    std::string_view pool_;
+};
+
+} // namespace dreamlang::lexer
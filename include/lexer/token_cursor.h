@@ -0,0 +1,101 @@
+#pragma once
+
+#include "lexical.h"
+#include <cstddef>
+#include <vector>
+
+namespace dreamlang::lexer {
+
+/**
+ * 带有限向前查看和回溯能力的Token游标
+ *
+ * Token按需从词法分析器取出，保存在固定容量的环形缓冲区中：当前位置之前且不被任何标记引用的Token
+ * 会被新Token覆盖，因此内存只与向前查看的距离和持有标记期间读过的Token数有关，而不是整个文件。
+ * 缓冲区只在持有标记（或向前查看超过容量）时才扩大。
+ * 到达EOF后 peek() 和 next() 一直返回EOF Token。
+ */
+class TokenCursor {
+public:
+    /**
+     * 标记：Token在整个Token流中的序号
+     */
+    using Mark = size_t;
+
+    /**
+     * 构造函数
+     * @param lexer 词法分析器，从它的当前位置开始取Token，需比游标活得更久
+     * @param capacity 环形缓冲区的初始容量（向上取整为 2 的幂）
+     */
+    explicit TokenCursor(Lexical& lexer, size_t capacity = 16);
+
+    // 游标引用词法分析器，禁止拷贝
+    TokenCursor(const TokenCursor&) = delete;
+    TokenCursor& operator=(const TokenCursor&) = delete;
+
+    /**
+     * 向前查看Token，不移动当前位置
+     * 返回的引用在下一次调用 peek() 或 next() 前有效
+     * @param k 距离，0 表示 next() 将要返回的Token
+     * @throws LexicalException 取Token时遇到词法错误（游标状态不变）
+     */
+    const Token& peek(size_t k = 0);
+
+    /**
+     * 取出当前Token并前进一个位置
+     * 返回的引用在下一次调用 peek() 或 next() 前有效
+     * @throws LexicalException 取Token时遇到词法错误（游标状态不变）
+     */
+    const Token& next();
+
+    /**
+     * 获取当前位置（下一个要返回的Token的序号）
+     */
+    [[nodiscard]] size_t position() const { return position_; }
+
+    /**
+     * 在当前位置设置标记，之后可以用 rewind() 回到这里
+     * 标记被 release() 之前，它之后的Token都保留在缓冲区中
+     */
+    Mark mark();
+
+    /**
+     * 回到标记的位置，标记仍然有效（可以再次回溯）
+     * @param mark 尚未释放的标记
+     */
+    void rewind(Mark mark);
+
+    /**
+     * 释放标记，之前的Token可以被覆盖
+     * @param mark 尚未释放的标记
+     */
+    void release(Mark mark);
+
+    /**
+     * 获取环形缓冲区的当前容量
+     */
+    [[nodiscard]] size_t capacity() const { return ring_.size(); }
+
+private:
+    /**
+     * 从词法分析器取一个Token追加到缓冲区末尾，必要时丢弃不再需要的Token或扩大缓冲区
+     */
+    void fill();
+
+    /**
+     * 获取序号对应的缓冲区位置
+     */
+    Token& slot(size_t index) { return ring_[index & (ring_.size() - 1)]; }
+
+    Lexical& lexer_;
+    // 容量为 2 的幂的环形缓冲区，保存序号 [base_, base_ + count_) 的Token
+    std::vector<Token> ring_;
+    size_t base_ = 0;
+    size_t count_ = 0;
+    size_t position_ = 0;
+    // 已取到EOF Token，之后不再调用词法分析器
+    bool at_eof_ = false;
+    // 尚未释放的标记，通常按嵌套顺序设置和释放
+    std::vector<Mark> marks_;
+};
+
+} // namespace dreamlang::lexer
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "output_buffer.h"
+#include "token.h"
+
+namespace dreamlang::lexer {
+
+/**
+ * Token列表的文本布局
+ */
+enum class TokenLayout {
+    // Token{type=..., value="...", line=...}，与 Token::toString() 相同，值原样输出
+    DEFAULT,
+    // 行号、类型、值三列对齐，值中的控制字符和反斜杠转义，适合阅读
+    ALIGNED,
+    // 以制表符分隔的行号、类型、值，值中的制表符、换行和反斜杠转义，适合交给其他工具处理
+    TSV
+};
+
+/**
+ * 把一个Token按布局格式化后追加到输出缓冲区（不含行尾换行）
+ * @param token Token
+ * @param out 输出缓冲区
+ * @param layout 布局
+ */
+void formatToken(const Token& token, OutputBuffer& out, TokenLayout layout = TokenLayout::DEFAULT);
+
+/**
+ * 追加布局的表头行（含行尾换行），DEFAULT 布局没有表头
+ */
+void formatTokenHeader(OutputBuffer& out, TokenLayout layout);
+
+} // namespace dreamlang::lexer
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "lexical.h"
+
+/**
+ * 编译器是否支持 C++20 协程
+ * 库本身按 C++17 构建，生成器只在头文件中实现，以 C++20 编译的使用者才能用到
+ */
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define DREAMLANG_HAS_COROUTINES 1
+#endif
+#endif
+
+#ifndef DREAMLANG_HAS_COROUTINES
+#define DREAMLANG_HAS_COROUTINES 0
+#endif
+
+#if DREAMLANG_HAS_COROUTINES
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace dreamlang::lexer {
+
+/**
+ * 按需产生Token的协程生成器，见 generateTokens()
+ * 每次恢复协程只分析一个Token，Token保存在协程帧中，迭代器取到的引用在下一次自增前有效
+ */
+class TokenGenerator {
+public:
+    struct promise_type {
+        const Token* current = nullptr;
+#if DREAMLANG_HAS_EXCEPTIONS
+        std::exception_ptr exception;
+#endif
+
+        TokenGenerator get_return_object() {
+            return TokenGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(const Token& token) noexcept {
+            current = &token;
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() {
+#if DREAMLANG_HAS_EXCEPTIONS
+            // 词法错误留到使用者恢复协程的地方重新抛出
+            exception = std::current_exception();
+#else
+            std::abort();
+#endif
+        }
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    /**
+     * 生成器的输入迭代器
+     */
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Token;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Token*;
+        using reference = const Token&;
+
+        Iterator() = default;
+
+        const Token& operator*() const { return *handle_.promise().current; }
+        const Token* operator->() const { return handle_.promise().current; }
+
+        Iterator& operator++() {
+            resume(handle_);
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const Iterator& it, std::default_sentinel_t) { return it.handle_.done(); }
+
+    private:
+        friend class TokenGenerator;
+
+        explicit Iterator(Handle handle) : handle_(handle) {}
+
+        Handle handle_;
+    };
+
+    TokenGenerator(TokenGenerator&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+    TokenGenerator& operator=(TokenGenerator&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    ~TokenGenerator() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    TokenGenerator(const TokenGenerator&) = delete;
+    TokenGenerator& operator=(const TokenGenerator&) = delete;
+
+    /**
+     * 开始产生Token，只能调用一次
+     */
+    Iterator begin() {
+        resume(handle_);
+        return Iterator(handle_);
+    }
+
+    std::default_sentinel_t end() const { return std::default_sentinel; }
+
+private:
+    explicit TokenGenerator(Handle handle) : handle_(handle) {}
+
+    /**
+     * 恢复协程直到产生下一个Token或结束，协程中抛出的词法错误在这里重新抛出
+     */
+    static void resume(Handle handle) {
+        handle.resume();
+#if DREAMLANG_HAS_EXCEPTIONS
+        if (handle.promise().exception) {
+            std::rethrow_exception(std::exchange(handle.promise().exception, nullptr));
+        }
+#endif
+    }
+
+    Handle handle_;
+};
+
+/**
+ * 以协程逐个产生词法分析器的Token，直到EOF Token（不包括EOF Token本身）
+ * 适合本身也会挂起的使用者（例如按需读入输入的语法分析协程），分析与使用交替进行，不需要先得到完整的Token列表
+ * @param lexer 词法分析器，需比生成器活得更久
+ */
+inline TokenGenerator generateTokens(Lexical& lexer) {
+    while (true) {
+        Token token = lexer.nextToken();
+        if (token.getType() == TokenType::EOF_TOKEN) {
+            co_return;
+        }
+        co_yield token;
+    }
+}
+
+} // namespace dreamlang::lexer
+
+#endif // DREAMLANG_HAS_COROUTINES
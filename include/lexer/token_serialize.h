@@ -1,15 +1,76 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include "output_buffer.h"
 #include "token.h"
 
 namespace dreamlang::lexer {
     /*
-     * 将 std::<vector><Token> 序列化为json,toml等格式的字符串
+     * JSON和TOML输出的版本，输出内容改变时递增，已生成的 .tokens 缓存随之失效
+     */
+    constexpr uint32_t TOKEN_SERIALIZE_VERSION = 1;
+
+    /*
+     * 序列化的排版方式
+     */
+    enum class SerializeStyle {
+        PRETTY,  // 缩进排版，每个字段一行
+        COMPACT  // 每个Token一行（JSON 不含任何空白）
+    };
+
+    /*
+     * 将Token列表以JSON格式流式写入输出缓冲区，不构造中间文档
+     * 每个Token为一个含 line、type、value 字段的对象，字符串按 JSON 规则转义，非法的 UTF-8 字节替换为 U+FFFD
+     * @param tokens Token列表
+     * @param out 输出缓冲区
+     * @param style 排版方式
+     */
+    void writeJson(const std::vector<Token>& tokens, OutputBuffer& out,
+                   SerializeStyle style = SerializeStyle::PRETTY);
+
+    /*
+     * 将Token列表以TOML格式流式写入输出缓冲区，不构造中间文档
+     * 每个Token为 tokens 表数组中的一项，字段与JSON相同
+     * @param tokens Token列表
+     * @param out 输出缓冲区
+     * @param style 排版方式，COMPACT 时每个Token写成一个内联表
+     */
+    void writeToml(const std::vector<Token>& tokens, OutputBuffer& out,
+                   SerializeStyle style = SerializeStyle::PRETTY);
+
+    /*
+     * 将Token列表以 MessagePack 格式流式写入输出缓冲区，不构造中间文档
+     * 文档为 {"tokens": [[line, type, value], ...], "types": [类型名, ...]}：type 是 TokenType 的整数编码，
+     * 即 types 中对应名称的下标；value 通常是字符串，不是合法 UTF-8 时写为二进制数据以保留原始字节
+     * @param tokens Token列表
+     * @param out 输出缓冲区
+     */
+    void writeMsgpack(const std::vector<Token>& tokens, OutputBuffer& out);
+
+    /*
+     * 将Token列表以 CBOR 格式流式写入输出缓冲区，文档结构与 writeMsgpack 相同
+     * @param tokens Token列表
+     * @param out 输出缓冲区
+     */
+    void writeCbor(const std::vector<Token>& tokens, OutputBuffer& out);
+
+    /*
+     * 将Token列表以指定格式流式写入输出缓冲区
+     * @param format "json"、"toml"、"msgpack" 或 "cbor"，二进制格式忽略 style
+     * @return 格式是否支持（不支持时不写入任何内容）
+     */
+    bool serialize(const std::vector<Token>& tokens, const std::string& format, OutputBuffer& out,
+                   SerializeStyle style = SerializeStyle::PRETTY);
+
+    /*
+     * 将 std::<vector><Token> 序列化为json,toml,msgpack,cbor等格式的字符串
+     * 输出较大时应直接使用写入 OutputBuffer 的版本
      * @param tokens Token列表
-     * @return 序列化后的字符串
+     * @return 序列化后的字符串，格式不支持时为空
      */
     std::string serialize(const std::vector<Token>& tokens,
-                          const std::string& format = "json");
+                          const std::string& format = "json",
+                          SerializeStyle style = SerializeStyle::PRETTY);
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace dreamlang::lexer {
 
 /**
@@ -86,6 +88,11 @@ enum class TokenType {
     EOF_TOKEN
 };
 
+/**
+ * TokenType的个数，类型的值从 0 连续编号
+ */
+constexpr size_t TOKEN_TYPE_COUNT = static_cast<size_t>(TokenType::EOF_TOKEN) + 1;
+
 /**
  * 将TokenType转换为字符串表示
  * @param type Token类型
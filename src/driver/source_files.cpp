@@ -0,0 +1,72 @@
+#include "driver/source_files.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace dreamlang::driver {
+
+std::string resolveSourceFile(const std::string& filename) {
+    // 如果文件名已经有扩展名，直接使用
+    if (filename.find('.') != std::string::npos) {
+        return filename;
+    }
+
+    // 尝试添加 .zv 后缀
+    std::string zv_filename = filename + SOURCE_EXTENSION;
+    std::ifstream test_file(zv_filename);
+    if (test_file.good()) {
+        test_file.close();
+        return zv_filename;
+    }
+
+    // 如果找不到 .zv 文件，返回原文件名（让后续错误处理处理）
+    return filename;
+}
+
+namespace {
+
+void collectDirectory(const std::filesystem::path& directory, std::vector<std::string>& files) {
+    namespace fs = std::filesystem;
+
+    std::vector<std::string> found;
+    std::error_code error;
+    fs::recursive_directory_iterator it(directory, fs::directory_options::skip_permission_denied, error);
+    for (; !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+        const fs::path& path = it->path();
+        std::string name = path.filename().string();
+        if (it->is_directory(error)) {
+            if (!name.empty() && name[0] == '.') {
+                it.disable_recursion_pending();
+            }
+            continue;
+        }
+        if (path.extension() == SOURCE_EXTENSION && it->is_regular_file(error)) {
+            found.push_back(path.string());
+        }
+    }
+
+    // 目录遍历顺序依赖文件系统，排序后输出才是确定的
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+}
+
+} // namespace
+
+std::vector<std::string> collectSourceFiles(const std::vector<std::string>& inputs, bool& has_directory) {
+    std::vector<std::string> files;
+    has_directory = false;
+    for (const auto& input : inputs) {
+        std::error_code error;
+        if (input == STDIN_SOURCE) {
+            files.push_back(input);
+        } else if (std::filesystem::is_directory(input, error)) {
+            has_directory = true;
+            collectDirectory(input, files);
+        } else {
+            files.push_back(resolveSourceFile(input));
+        }
+    }
+    return files;
+}
+
+} // namespace dreamlang::driver
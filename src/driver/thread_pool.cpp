@@ -0,0 +1,107 @@
+#include "driver/thread_pool.h"
+#include <algorithm>
+
+namespace dreamlang::driver {
+
+ThreadPool::ThreadPool(unsigned threads)
+    : next_queue_(0), queued_(0), unfinished_(0), stopping_(false) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    queues_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(Task task) {
+    // 先计数再入队，保证任务被取走时计数已经包含它
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        ++queued_;
+        ++unfinished_;
+    }
+    Queue& queue = *queues_[next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    work_available_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    all_done_.wait(lock, [this] { return unfinished_ == 0; });
+}
+
+bool ThreadPool::popLocal(size_t self, Task& task) {
+    Queue& queue = *queues_[self];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    // 先进先出：按提交顺序消费结果的调用者不必等整个队列排空
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool ThreadPool::steal(size_t self, Task& task) {
+    // 从下一个线程开始依次尝试，避免所有空闲线程都去窃取同一个队列
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+        Queue& victim = *queues_[(self + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t self) {
+    while (true) {
+        Task task;
+        if (popLocal(self, task) || steal(self, task)) {
+            {
+                std::lock_guard<std::mutex> lock(state_mutex_);
+                --queued_;
+            }
+            try {
+                task();
+            } catch (...) {
+                // 任务应自行处理错误，这里只保证工作线程不会因此退出
+            }
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            if (--unfinished_ == 0) {
+                all_done_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(state_mutex_);
+        work_available_.wait(lock, [this] { return queued_ > 0 || stopping_; });
+        if (stopping_ && queued_ == 0) {
+            return;
+        }
+    }
+}
+
+} // namespace dreamlang::driver
@@ -0,0 +1,145 @@
+#include "driver/token_manifest.h"
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+namespace dreamlang::driver {
+
+namespace {
+
+// 清单文件的第一行，格式变化时修改
+constexpr const char* MANIFEST_HEADER = "dreamlang-tokens-manifest 1";
+
+/**
+ * 生成同一目录下不会与其他线程或进程冲突的临时文件名
+ */
+std::filesystem::path temporaryPath(const std::filesystem::path& path) {
+    static std::atomic<uint64_t> counter{0};
+    static const uint64_t process_tag = std::random_device{}();
+    std::string name = path.filename().string() + ".tmp." + std::to_string(process_tag) + "." +
+                       std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+    return path.parent_path() / name;
+}
+
+} // namespace
+
+bool writeFileAtomically(const std::filesystem::path& path, std::string_view content) {
+    return writeFileAtomically(path, [content](std::ostream& file) {
+        file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    });
+}
+
+bool writeFileAtomically(const std::filesystem::path& path, const std::function<void(std::ostream&)>& write) {
+    std::filesystem::path temporary = temporaryPath(path);
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        write(file);
+        file.close();
+        if (!file) {
+            std::error_code ignored;
+            std::filesystem::remove(temporary, ignored);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::error_code ignored;
+        std::filesystem::remove(temporary, ignored);
+        return false;
+    }
+    return true;
+}
+
+ManifestCache::ManifestCache(std::string key) : key_(std::move(key)) {
+}
+
+std::optional<ManifestEntry> ManifestCache::find(const std::filesystem::path& tokens_dir, const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = loaded_.find(tokens_dir);
+    if (it == loaded_.end()) {
+        it = loaded_.emplace(tokens_dir, load(tokens_dir)).first;
+    }
+    auto entry = it->second.find(name);
+    if (entry == it->second.end()) {
+        return std::nullopt;
+    }
+    return entry->second;
+}
+
+void ManifestCache::update(const std::filesystem::path& tokens_dir, const std::string& name,
+                           const ManifestEntry& entry) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_[tokens_dir][name] = entry;
+}
+
+size_t ManifestCache::save() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t failures = 0;
+    for (auto& [tokens_dir, updates] : pending_) {
+        Entries entries = load(tokens_dir);
+        for (auto& [name, entry] : updates) {
+            entries[name] = entry;
+        }
+
+        std::ostringstream content;
+        content << MANIFEST_HEADER << '\n' << "key " << key_ << '\n';
+        for (const auto& [name, entry] : entries) {
+            char hash[17];
+            std::snprintf(hash, sizeof(hash), "%016" PRIx64, entry.hash);
+            content << hash << ' ' << entry.size << ' ' << entry.tokens << ' ' << name << '\n';
+        }
+        if (!writeFileAtomically(tokens_dir / MANIFEST_FILENAME, content.str())) {
+            ++failures;
+        }
+        loaded_[tokens_dir] = std::move(entries);
+    }
+    pending_.clear();
+    return failures;
+}
+
+ManifestCache::Entries ManifestCache::load(const std::filesystem::path& tokens_dir) const {
+    Entries entries;
+    std::ifstream file(tokens_dir / MANIFEST_FILENAME, std::ios::binary);
+    std::string line;
+    if (!file.is_open() || !std::getline(file, line) || line != MANIFEST_HEADER) {
+        return entries;
+    }
+    // 词法分析器版本或配置不同，全部记录都已失效
+    if (!std::getline(file, line) || line != "key " + key_) {
+        return entries;
+    }
+
+    // 每行：十六进制哈希 长度 Token数 文件名（文件名可以含空格，放在最后）
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string hash;
+        ManifestEntry entry;
+        if (!(fields >> hash >> entry.size >> entry.tokens) || hash.size() != 16) {
+            return {};
+        }
+        std::string name;
+        fields.get();
+        std::getline(fields, name);
+        if (name.empty()) {
+            return {};
+        }
+        char* hash_end = nullptr;
+        entry.hash = std::strtoull(hash.c_str(), &hash_end, 16);
+        if (hash_end != hash.c_str() + hash.size()) {
+            return {};
+        }
+        entries[name] = entry;
+    }
+    return entries;
+}
+
+} // namespace dreamlang::driver
@@ -1,4 +1,5 @@
 #include "i18n/locale_manager.h"
+#include <cstring>
 #include <iostream>
 
 namespace dreamlang::i18n {
@@ -0,0 +1,38 @@
+#include "lexer/diagnostic.h"
+#include "i18n/locale_manager.h"
+
+namespace dreamlang::lexer {
+
+const char* lexicalErrorMessage(LexicalErrorCode code) {
+    switch (code) {
+        case LexicalErrorCode::INVALID_CHARACTER: return N_("Invalid character");
+        case LexicalErrorCode::UNEXPECTED_CHARACTER: return N_("Unexpected character");
+        case LexicalErrorCode::UNTERMINATED_COMMENT: return N_("Unterminated comment");
+        case LexicalErrorCode::INVALID_HEX_NUMBER: return N_("Invalid hexadecimal number");
+        case LexicalErrorCode::INVALID_BINARY_NUMBER: return N_("Invalid binary number");
+        case LexicalErrorCode::INVALID_OCTAL_NUMBER: return N_("Invalid octal number");
+        case LexicalErrorCode::INVALID_NUMBER_FORMAT: return N_("Invalid number format");
+        case LexicalErrorCode::UNTERMINATED_STRING: return N_("Unterminated string");
+        case LexicalErrorCode::UNTERMINATED_CHAR: return N_("Unterminated character literal");
+        case LexicalErrorCode::INVALID_ESCAPE: return N_("Invalid escape sequence");
+        case LexicalErrorCode::NUMBER_OUT_OF_RANGE: return N_("Number out of range");
+        default: return N_("Unexpected character");
+    }
+}
+
+const char* lexicalErrorTokenType(LexicalErrorCode code) {
+    switch (code) {
+        case LexicalErrorCode::UNTERMINATED_COMMENT: return "MULTI_COMMENT";
+        case LexicalErrorCode::INVALID_HEX_NUMBER:
+        case LexicalErrorCode::INVALID_BINARY_NUMBER:
+        case LexicalErrorCode::INVALID_OCTAL_NUMBER:
+        case LexicalErrorCode::INVALID_NUMBER_FORMAT:
+        case LexicalErrorCode::NUMBER_OUT_OF_RANGE: return "NUMBER";
+        case LexicalErrorCode::UNTERMINATED_STRING: return "STRING";
+        case LexicalErrorCode::UNTERMINATED_CHAR: return "CHAR";
+        case LexicalErrorCode::INVALID_ESCAPE: return "ESCAPE";
+        default: return "UNKNOWN";
+    }
+}
+
+} // namespace dreamlang::lexer
@@ -1,35 +1,104 @@
 #include "lexer/lexical.h"
-#include "i18n/locale_manager.h"
+#include "lexer/keyword_table.h"
+#include "lexer/simd_scan.h"
+#include <algorithm>
+#include <cfloat>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
 
 
 namespace dreamlang::lexer {
 
-// 静态成员初始化
-std::unordered_set<std::string> Lexical::keywords_;
-bool Lexical::initialized_ = false;
+namespace {
 
-Lexical::Lexical(std::string source_code)
-    : source_code_(std::move(source_code)), index_(0), line_(1), column_(1) {
-    if (!initialized_) {
-        initializeStatic();
-        initialized_ = true;
-    }
+// 不超过 19 位有效数字的十进制整数不会超出 uint64
+constexpr size_t MAX_EXACT_DIGITS = 19;
+constexpr uint64_t INT64_LIMIT = static_cast<uint64_t>(INT64_MAX);
+// 能精确表示为 double 的最大尾数和最大的 10 的幂
+constexpr uint64_t MAX_EXACT_MANTISSA = uint64_t{1} << 53;
+constexpr int64_t MAX_EXACT_POWER = 22;
+// 中间结果有更高精度（如 x87）时一次乘除不一定正确舍入
+constexpr bool EXACT_DOUBLE_ARITHMETIC = FLT_EVAL_METHOD == 0;
+
+constexpr double POWERS_OF_TEN[MAX_EXACT_POWER + 1] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+inline uint64_t hexDigitValue(char c) {
+    return c <= '9' ? static_cast<uint64_t>(c - '0') : static_cast<uint64_t>((c | 0x20) - 'a' + 10);
+}
+
+/**
+ * 把浮点数字面量的文本转换为正确舍入的 double，超出范围时返回 false
+ */
+bool parseFloat(std::string_view text, double& value) {
+#if defined(__cpp_lib_to_chars)
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc();
+#else
+    // 标准库没有浮点数的 from_chars 时按 "C" 区域设置解析，不受程序区域设置的影响
+    std::istringstream stream{std::string(text)};
+    stream.imbue(std::locale::classic());
+    stream >> value;
+    return !stream.fail();
+#endif
+}
+
+} // namespace
+
+Lexical::Lexical(std::string source_code, LexerOptions options)
+    : owned_source_(std::move(source_code)), source_code_(owned_source_), options_(options), index_(0),
+      token_start_(0), line_(1), line_start_(0) {
+}
+
+Lexical::Lexical(std::string_view source_code, LexerOptions options, BorrowedSource)
+    : source_code_(source_code), options_(options), index_(0), token_start_(0), line_(1), line_start_(0) {
 }
 
-void Lexical::initializeStatic() {
-    keywords_ = {
-        "bool", "number", "char", "string", "function", "array", "class", "object",
-        "reference", "package", "import", "var", "val", "ref", "return", "fun",
-        "if", "else", "for", "while", "break", "continue", "switch", "case",
-        "default", "super", "this", "available", "in", "interface", "abstract",
-        "null", "true", "false"
-    };
+Lexical Lexical::borrowed(std::string_view source_code, LexerOptions options) {
+    return Lexical(source_code, options, BorrowedSource{});
 }
 
 Token Lexical::nextToken() {
+    Token token = scanToken();
+    if (options_.value_mode == TokenValueMode::OWNED && !token.ownsValue()) {
+        if (token.hasSymbol()) {
+            // 标识符的名字只在驻留表中保存一份
+            token.assignBorrowed(options_.symbols->text(token.getSymbol()));
+            return token;
+        }
+        // 就地改为持有值副本，保留数值等其他字段
+        token.assignOwned(token.getValue());
+    }
+    return token;
+}
+
+Lexical::Iterator& Lexical::Iterator::operator++() {
+    token_ = lexer_->nextToken();
+    return *this;
+}
+
+Token Lexical::scanToken() {
+    if (stopped_) {
+        beginToken();
+        return makeToken(TokenType::EOF_TOKEN);
+    }
+    if (options_.backend == LexerBackend::TABLE) {
+        return scanTokenTable();
+    }
+    return scanTokenSwitch();
+}
+
+Token Lexical::scanTokenSwitch() {
     while (true) {
         skipWhitespace();
 
+        beginToken();
+
         if (isAtEnd()) {
             return makeToken(TokenType::EOF_TOKEN);
         }
@@ -39,7 +108,7 @@ Token Lexical::nextToken() {
         // 处理换行符
         if (c == '\n') {
             advance();
-            return makeToken(TokenType::LINEBREAK, "\n");
+            return makeToken(TokenType::LINEBREAK);
         }
 
         // 处理注释
@@ -49,7 +118,9 @@ Token Lexical::nextToken() {
         }
 
         if (c == '/' && peekChar() == '*') {
-            skipMultiLineComment();
+            if (!skipMultiLineComment()) {
+                return makeToken(TokenType::ILLEGAL);
+            }
             continue; // 继续循环而不是递归调用
         }
 
@@ -79,118 +150,120 @@ Token Lexical::nextToken() {
                 advance();
                 if (currentChar() == '=' && !isAtEnd()) {
                     advance();
-                    return makeToken(TokenType::EQUAL, "==");
+                    return makeToken(TokenType::EQUAL);
                 }
-                return makeToken(TokenType::ASSIGN, "=");
+                return makeToken(TokenType::ASSIGN);
 
             case '!':
                 advance();
                 if (currentChar() == '=' && !isAtEnd()) {
                     advance();
-                    return makeToken(TokenType::NOT_EQUAL, "!=");
+                    return makeToken(TokenType::NOT_EQUAL);
                 }
-                return makeToken(TokenType::LOGICAL_NOT, "!");
+                return makeToken(TokenType::LOGICAL_NOT);
 
             case '<':
                 advance();
                 if (currentChar() == '=' && !isAtEnd()) {
                     advance();
-                    return makeToken(TokenType::LESS_EQUAL, "<=");
+                    return makeToken(TokenType::LESS_EQUAL);
                 }
-                return makeToken(TokenType::LESS, "<");
+                return makeToken(TokenType::LESS);
 
             case '>':
                 advance();
                 if (currentChar() == '=' && !isAtEnd()) {
                     advance();
-                    return makeToken(TokenType::GREATER_EQUAL, ">=");
+                    return makeToken(TokenType::GREATER_EQUAL);
                 }
-                return makeToken(TokenType::GREATER, ">");
+                return makeToken(TokenType::GREATER);
 
             case '&':
                 advance();
                 if (currentChar() == '&' && !isAtEnd()) {
                     advance();
-                    return makeToken(TokenType::LOGICAL_AND, "&&");
+                    return makeToken(TokenType::LOGICAL_AND);
                 }
-                throwError(_("Invalid character"), c, "UNKNOWN");
-                break;
+                reportError(LexicalErrorCode::INVALID_CHARACTER, c);
+                return makeToken(TokenType::ILLEGAL);
 
             case '|':
                 advance();
                 if (currentChar() == '|' && !isAtEnd()) {
                     advance();
-                    return makeToken(TokenType::LOGICAL_OR, "||");
+                    return makeToken(TokenType::LOGICAL_OR);
                 }
-                throwError(_("Invalid character"), c, "UNKNOWN");
-                break;
+                reportError(LexicalErrorCode::INVALID_CHARACTER, c);
+                return makeToken(TokenType::ILLEGAL);
 
             case '+':
                 advance();
-                return makeToken(TokenType::PLUS, "+");
+                return makeToken(TokenType::PLUS);
 
             case '-':
                 advance();
-                return makeToken(TokenType::MINUS, "-");
+                return makeToken(TokenType::MINUS);
 
             case '*':
                 advance();
                 if (currentChar() == '*' && !isAtEnd()) {
                     advance();
-                    return makeToken(TokenType::POWER, "**");
+                    return makeToken(TokenType::POWER);
                 }
-                return makeToken(TokenType::MULT, "*");
+                return makeToken(TokenType::MULT);
 
             case '/':
                 advance();
-                return makeToken(TokenType::DIVIDE, "/");
+                return makeToken(TokenType::DIVIDE);
 
             case '%':
                 advance();
-                return makeToken(TokenType::MODULO, "%");
+                return makeToken(TokenType::MODULO);
 
             case '.':
                 advance();
-                return makeToken(TokenType::DOT, ".");
+                return makeToken(TokenType::DOT);
 
             case ',':
                 advance();
-                return makeToken(TokenType::COMMA, ",");
+                return makeToken(TokenType::COMMA);
 
             case ':':
                 advance();
-                return makeToken(TokenType::COLON, ":");
+                return makeToken(TokenType::COLON);
 
             case ';':
                 advance();
-                return makeToken(TokenType::SEMICOLON, ";");
+                return makeToken(TokenType::SEMICOLON);
 
             case '(':
                 advance();
-                return makeToken(TokenType::LEFT_PAREN, "(");
+                return makeToken(TokenType::LEFT_PAREN);
 
             case ')':
                 advance();
-                return makeToken(TokenType::RIGHT_PAREN, ")");
+                return makeToken(TokenType::RIGHT_PAREN);
 
             case '[':
                 advance();
-                return makeToken(TokenType::LEFT_BRACKET, "[");
+                return makeToken(TokenType::LEFT_BRACKET);
 
             case ']':
                 advance();
-                return makeToken(TokenType::RIGHT_BRACKET, "]");
+                return makeToken(TokenType::RIGHT_BRACKET);
 
             case '{':
                 advance();
-                return makeToken(TokenType::LEFT_BRACE, "{");
+                return makeToken(TokenType::LEFT_BRACE);
 
             case '}':
                 advance();
-                return makeToken(TokenType::RIGHT_BRACE, "}");
+                return makeToken(TokenType::RIGHT_BRACE);
 
             default:
-                throwError(_("Unexpected character"), c, "UNKNOWN");
+                reportError(LexicalErrorCode::UNEXPECTED_CHARACTER, c);
+                skipIllegalCharacter();
+                return makeToken(TokenType::ILLEGAL);
         }
     }
 }
@@ -207,14 +280,162 @@ std::vector<Token> Lexical::tokenize() {
         }
     }
     
+    beginToken();
     tokens.push_back(makeToken(TokenType::EOF_TOKEN));
     return tokens;
 }
 
+std::pmr::vector<Token> Lexical::tokenize(std::pmr::memory_resource* resource) {
+    std::pmr::vector<Token> tokens(resource);
+    // 与 tokenizeInto(TokenBuffer&) 相同的估计，避免数组在 arena 中反复增长留下废弃的旧块
+    tokens.reserve(source_code_.size() / 4 + 1);
+
+    const char* const source_begin = source_code_.data();
+    const char* const source_end = source_begin + source_code_.size();
+    value_resource_ = resource;
+    while (true) {
+        Token token = scanToken();
+        std::string_view value = token.getValue();
+        // 解码后的值已经在内存资源中，只有引用源码的值需要在 OWNED 模式下拷贝
+        if (options_.value_mode == TokenValueMode::OWNED && value.data() >= source_begin &&
+            value.data() <= source_end) {
+            if (token.hasSymbol()) {
+                token.assignBorrowed(options_.symbols->text(token.getSymbol()));
+            } else {
+                token.assignBorrowed(storeValue(resource, value));
+            }
+        }
+        bool at_end = token.getType() == TokenType::EOF_TOKEN;
+        tokens.push_back(std::move(token));
+        if (at_end) {
+            break;
+        }
+    }
+    value_resource_ = nullptr;
+    return tokens;
+}
+
+void Lexical::tokenizeInto(TokenArena& arena) {
+    arena.clear();
+    arena.tokens_ = tokenize(arena.resource());
+}
+
+LexResult Lexical::tryTokenize() {
+    bool recover_errors = options_.recover_errors;
+    options_.recover_errors = true;
+    LexResult result;
+    result.tokens = tokenize();
+    result.diagnostics = std::move(diagnostics_);
+    result.stopped = stopped_;
+    diagnostics_.clear();
+    options_.recover_errors = recover_errors;
+    return result;
+}
+
+ScanSummary Lexical::scan() {
+    // 抛出词法错误时也要恢复，之后的 nextToken() 仍需返回完整的值
+    struct DiscardValues {
+        bool& flag;
+        ~DiscardValues() { flag = false; }
+    } discard{discard_values_};
+    discard_values_ = true;
+
+    // Token只作为临时值取出类型，值都引用源码，不涉及内存分配
+    ScanSummary summary;
+    while (true) {
+        TokenType type = scanToken().getType();
+        ++summary.counts[static_cast<size_t>(type)];
+        ++summary.tokens;
+        if (type == TokenType::EOF_TOKEN) {
+            return summary;
+        }
+    }
+}
+
+void Lexical::tokenizeInto(TokenBuffer& buffer) {
+    // 缓冲区使用 32 位偏移
+    if (source_code_.size() > UINT32_MAX) {
+        DREAMLANG_THROW(std::length_error("source too large for TokenBuffer"));
+    }
+
+    buffer.attach(source_code_);
+    // 粗略估计：平均每个Token约占 4 个字节的源码
+    buffer.reserve(source_code_.size() / 4 + 1);
+
+    while (true) {
+        Token token = scanToken();
+        if (token.ownsValue()) {
+            // 含转义的字面量：偏移和长度指向引号内未解码的文本
+            buffer.appendDecoded(token.getType(), token_start_ + 1, index_ - token_start_ - 2,
+                                 token.getValue(), token.getLine());
+        } else {
+            buffer.append(token.getType(), token.getValue().data() - source_code_.data(),
+                          token.getValue().size(), token.getLine());
+        }
+        if (token.getType() == TokenType::EOF_TOKEN) {
+            break;
+        }
+    }
+}
+
 void Lexical::reset() {
     index_ = 0;
     line_ = 1;
-    column_ = 1;
+    line_start_ = 0;
+    beginToken();
+    diagnostics_.clear();
+    stopped_ = false;
+}
+
+void Lexical::seek(size_t index, int line) {
+    index_ = index;
+    line_ = line;
+    if (options_.track_positions) {
+        const char* base = source_code_.data();
+        size_t line_start = index;
+        while (line_start > 0 && base[line_start - 1] != '\n') {
+            --line_start;
+        }
+        line_start_ = line_start;
+    }
+    beginToken();
+}
+
+int Lexical::getCurrentLine() const {
+    return options_.track_positions ? line_ : lineOf(index_);
+}
+
+int Lexical::getCurrentColumn() const {
+    return options_.track_positions ? static_cast<int>(index_ - line_start_) + 1 : columnOf(index_);
+}
+
+void Lexical::buildNewlineIndex() const {
+    const char* base = source_code_.data();
+    const char* end = base + source_code_.size();
+    newline_index_.clear();
+    newline_index_.reserve(simd::countNewlines(base, end));
+    for (const char* p = simd::findNewline(base, end); p != end; p = simd::findNewline(p + 1, end)) {
+        newline_index_.push_back(p - base);
+    }
+    newline_index_built_ = true;
+}
+
+int Lexical::lineOf(size_t offset) const {
+    if (!newline_index_built_) {
+        buildNewlineIndex();
+    }
+    // 行号 = 1 + 偏移之前的换行符个数
+    auto it = std::lower_bound(newline_index_.begin(), newline_index_.end(), offset);
+    return static_cast<int>(it - newline_index_.begin()) + 1;
+}
+
+int Lexical::columnOf(size_t offset) const {
+    if (!newline_index_built_) {
+        buildNewlineIndex();
+    }
+    auto it = std::lower_bound(newline_index_.begin(), newline_index_.end(), offset);
+    size_t line_start = it == newline_index_.begin() ? 0 : *(it - 1) + 1;
+    return static_cast<int>(offset - line_start) + 1;
 }
 
 char Lexical::currentChar() const {
@@ -234,53 +455,61 @@ char Lexical::peekChar(size_t offset) const {
 
 void Lexical::advance() {
     if (!isAtEnd()) {
-        if (source_code_[index_] == '\n') {
+        if (options_.track_positions && source_code_[index_] == '\n') {
             line_++;
-            column_ = 1;
-        } else {
-            column_++;
+            line_start_ = index_ + 1;
         }
         index_++;
     }
 }
-void Lexical::skipWhitespace() {
-    while (!isAtEnd()) {
-        char c = currentChar();
-        if (c == ' ' || c == '\r' || c == '\t') {
-            advance();
-        } else {
-            break;
+
+void Lexical::advanceTo(size_t index) {
+    index_ = index;
+}
+
+void Lexical::advanceAcross(size_t index, size_t newlines) {
+    if (newlines != 0 && options_.track_positions) {
+        const char* base = source_code_.data();
+        size_t last_newline = index - 1;
+        while (base[last_newline] != '\n') {
+            --last_newline;
         }
+        line_ += static_cast<int>(newlines);
+        line_start_ = last_newline + 1;
     }
+    index_ = index;
+}
+
+void Lexical::skipWhitespace() {
+    // 空白不包含换行符，不影响行号
+    const char* base = source_code_.data();
+    advanceTo(simd::skipBlanks(base + index_, base + source_code_.size()) - base);
 }
 
 void Lexical::skipSingleLineComment() {
-    // 跳过 //
-    advance();
-    advance();
-    
-    while (!isAtEnd() && currentChar() != '\n') {
-        advance();
-    }
+    // 跳过 // 直到换行符（换行符本身留给 LINEBREAK）
+    const char* base = source_code_.data();
+    advanceTo(simd::findNewline(base + index_ + 2, base + source_code_.size()) - base);
 }
 
-void Lexical::skipMultiLineComment() {
-    // 跳过 /*
-    advance();
-    advance();
-    
-    while (!isAtEnd()) {
-        if (currentChar() == '*' && peekChar() == '/') {
-            advance(); // 跳过 *
-            advance(); // 跳过 /
-            break;
-        }
-        advance();
+bool Lexical::skipMultiLineComment() {
+    // 跳过 /* 之后查找 */，途经的换行符一次性计入行号
+    const char* base = source_code_.data();
+    const char* begin = base + index_;
+    const char* end = base + source_code_.size();
+    size_t newlines = 0;
+    const char* stop = simd::findCommentEnd(begin + 2, end, newlines);
+    bool terminated = stop != end;
+    if (terminated) {
+        stop += 2; // 跳过 */
     }
-    
-    if (isAtEnd()) {
-        throwError(_("Unterminated comment"), '*', "MULTI_COMMENT");
+
+    advanceAcross(stop - base, newlines);
+
+    if (!terminated) {
+        reportError(LexicalErrorCode::UNTERMINATED_COMMENT, '*');
     }
+    return terminated;
 }
 
 Token Lexical::readIdentifierOrKeyword() {
@@ -290,25 +519,12 @@ Token Lexical::readIdentifierOrKeyword() {
         advance();
     }
     
-    std::string text = source_code_.substr(start, index_ - start);
-    
-    // 检查特殊字面量
-    if (text == "null") {
-        return makeToken(TokenType::NULL_LITERAL, text);
-    } else if (text == "true") {
-        return makeToken(TokenType::BOOL_TRUE, text);
-    } else if (text == "false") {
-        return makeToken(TokenType::BOOL_FALSE, text);
-    } else if (isKeyword(text)) {
-        return makeToken(TokenType::KEYWORD, text);
-    } else {
-        return makeToken(TokenType::IDENT, text);
-    }
+    // 关键字和 null/true/false 由编译期生成的完美哈希表一次查出
+    std::string_view text(source_code_.data() + start, index_ - start);
+    return makeWordToken(lookupKeyword(text));
 }
 
 Token Lexical::readNumber() {
-    size_t start = index_;
-    
     if (currentChar() == '0' && !isAtEnd()) {
         char next = peekChar();
         
@@ -317,13 +533,17 @@ Token Lexical::readNumber() {
             advance(); // 跳过 '0'
             advance(); // 跳过 'x' 或 'X'
             if (isAtEnd() || !isHexDigit(currentChar())) {
-                throwError(_("Invalid hexadecimal number"), currentChar(), "NUMBER");
+                reportError(LexicalErrorCode::INVALID_HEX_NUMBER, currentChar());
+                return recoverIllegalWord();
             }
+            uint64_t value = 0;
+            bool overflow = false;
             while (!isAtEnd() && isHexDigit(currentChar())) {
+                overflow |= value > (INT64_LIMIT >> 4);
+                value = (value << 4) | hexDigitValue(currentChar());
                 advance();
             }
-            std::string text = source_code_.substr(start, index_ - start);
-            return makeToken(TokenType::NUMBER, text);
+            return makeIntegerToken(value, overflow);
         }
         
         // 处理二进制数字
@@ -331,13 +551,17 @@ Token Lexical::readNumber() {
             advance(); // 跳过 '0'
             advance(); // 跳过 'b' 或 'B'
             if (isAtEnd() || (currentChar() != '0' && currentChar() != '1')) {
-                throwError(_("Invalid binary number"), currentChar(), "NUMBER");
+                reportError(LexicalErrorCode::INVALID_BINARY_NUMBER, currentChar());
+                return recoverIllegalWord();
             }
+            uint64_t value = 0;
+            bool overflow = false;
             while (!isAtEnd() && (currentChar() == '0' || currentChar() == '1')) {
+                overflow |= value > (INT64_LIMIT >> 1);
+                value = (value << 1) | static_cast<uint64_t>(currentChar() - '0');
                 advance();
             }
-            std::string text = source_code_.substr(start, index_ - start);
-            return makeToken(TokenType::NUMBER, text);
+            return makeIntegerToken(value, overflow);
         }
         
         // 处理八进制数字
@@ -345,99 +569,179 @@ Token Lexical::readNumber() {
             advance(); // 跳过 '0'
             advance(); // 跳过 'o' 或 'O'
             if (isAtEnd() || (currentChar() < '0' || currentChar() > '7')) {
-                throwError(_("Invalid octal number"), currentChar(), "NUMBER");
+                reportError(LexicalErrorCode::INVALID_OCTAL_NUMBER, currentChar());
+                return recoverIllegalWord();
             }
+            uint64_t value = 0;
+            bool overflow = false;
             while (!isAtEnd() && (currentChar() >= '0' && currentChar() <= '7')) {
+                overflow |= value > (INT64_LIMIT >> 3);
+                value = (value << 3) | static_cast<uint64_t>(currentChar() - '0');
                 advance();
             }
-            std::string text = source_code_.substr(start, index_ - start);
-            return makeToken(TokenType::NUMBER, text);
+            return makeIntegerToken(value, overflow);
         }
     }
     
-    // 处理普通的十进制数字
+    // 处理普通的十进制数字：整数部分和小数部分的数字累加到同一个尾数中
+    uint64_t mantissa = 0;
+    size_t digits = 0;
+    int64_t exponent = 0;
+    bool is_float = false;
     while (!isAtEnd() && isDigit(currentChar())) {
+        uint64_t digit = static_cast<uint64_t>(currentChar() - '0');
+        mantissa = mantissa * 10 + digit;
+        digits += digits != 0 || digit != 0;
         advance();
     }
 
     
     // 处理小数点
     if (!isAtEnd() && currentChar() == '.' && isDigit(peekChar())) {
+        is_float = true;
         advance(); // 跳过小数点
         while (!isAtEnd() && isDigit(currentChar())) {
+            uint64_t digit = static_cast<uint64_t>(currentChar() - '0');
+            mantissa = mantissa * 10 + digit;
+            digits += digits != 0 || digit != 0;
+            --exponent;
             advance();
         }
     }
     
     // 处理科学计数法
     if (!isAtEnd() && (currentChar() == 'e' || currentChar() == 'E')) {
+        is_float = true;
         advance();
+        bool negative = currentChar() == '-';
         if (!isAtEnd() && (currentChar() == '+' || currentChar() == '-')) {
             advance();
         }
         if (isAtEnd() || !isDigit(currentChar())) {
-            throwError(_("Invalid number format"), currentChar(), "NUMBER");
+            reportError(LexicalErrorCode::INVALID_NUMBER_FORMAT, currentChar());
+            return recoverIllegalWord();
         }
+        int64_t power = 0;
         while (!isAtEnd() && isDigit(currentChar())) {
+            if (power < EXPONENT_LIMIT) {
+                power = power * 10 + (currentChar() - '0');
+            }
             advance();
         }
+        exponent += negative ? -power : power;
     }
     
-    std::string text = source_code_.substr(start, index_ - start);
-    return makeToken(TokenType::NUMBER, text);
+    return makeDecimalToken(mantissa, digits, exponent, is_float);
 }
 
 Token Lexical::readString() {
     advance(); // 跳过开始的双引号
-    
-    std::string value;
-    
-    while (!isAtEnd() && currentChar() != '"') {
-        if (currentChar() == '\\') {
+
+    const char* const base = source_code_.data();
+    const char* const end = base + source_code_.size();
+    const char* const content_start = base + index_;
+    // 尚未拷贝到 value 的连续文本的起点
+    const char* run_start = content_start;
+    const char* p = content_start;
+    size_t reported = diagnostics_.size();
+    // 只有遇到转义或 CRLF 时才需要解码到 value 中，否则直接引用源码
+    bool has_escape = false;
+    std::string& value = decoded_;
+    value.clear();
+
+    while (true) {
+        // 一次跳过一整段普通文本，途经的换行符一次性计入行号
+        size_t newlines = 0;
+        p = simd::findStringSpecial(p, end, newlines);
+        advanceAcross(p - base, newlines);
+
+        if (p == end) {
+            reportError(LexicalErrorCode::UNTERMINATED_STRING, '"');
+            return makeToken(TokenType::ILLEGAL);
+        }
+
+        if (*p == '"') {
+            advance(); // 跳过结束的双引号
+            if (diagnostics_.size() != reported) {
+                // 含无效转义的字符串整体作为 ILLEGAL Token，从结束的双引号之后继续
+                return makeToken(TokenType::ILLEGAL);
+            }
+            if (has_escape) {
+                value.append(run_start, p);
+                return makeDecodedToken(TokenType::STRING, value);
+            }
+            return makeToken(TokenType::STRING, std::string_view(content_start, p - content_start));
+        }
+
+        if (*p == '\\') {
+            // 之前的连续文本整段拷贝，只在转义处逐个解码
+            value.append(run_start, p);
+            has_escape = true;
             advance();
-            char escaped = processEscapeSequence();
-            value += escaped;
+            value += processEscapeSequence();
+            p = base + index_;
+            run_start = p;
         } else {
-            value += currentChar();
-            advance();
+            // 跨行字符串中的 CRLF 统一为 LF，去掉 '\n' 前的 '\r'；单独的 '\r' 原样保留
+            if (p + 1 < end && p[1] == '\n') {
+                value.append(run_start, p);
+                has_escape = true;
+                run_start = p + 1;
+            }
+            ++p;
         }
     }
-    
-    if (isAtEnd()) {
-        throwError(_("Unterminated string"), '"', "STRING");
-    }
-    
-    advance(); // 跳过结束的双引号
-    return makeToken(TokenType::STRING, value);
 }
 
 Token Lexical::readChar() {
     advance(); // 跳过开始的单引号
     
     if (isAtEnd()) {
-        throwError(_("Unterminated character literal"), '\'', "CHAR");
+        reportError(LexicalErrorCode::UNTERMINATED_CHAR, '\'');
+        return makeToken(TokenType::ILLEGAL);
     }
     
+    size_t content_start = index_;
+    size_t reported = diagnostics_.size();
+    bool has_escape = false;
     char value;
     if (currentChar() == '\\') {
         advance();
         value = processEscapeSequence();
+        has_escape = true;
     } else {
         value = currentChar();
         advance();
     }
     
     if (isAtEnd() || currentChar() != '\'') {
-        throwError(_("Unterminated character literal"), '\'', "CHAR");
+        reportError(LexicalErrorCode::UNTERMINATED_CHAR, '\'');
+        // 越过同一行内结束的单引号（如 'ab'），找不到时停在行尾
+        size_t stop = index_;
+        while (stop < source_code_.size() && source_code_[stop] != '\'' && source_code_[stop] != '\n') {
+            ++stop;
+        }
+        if (stop < source_code_.size() && source_code_[stop] == '\'') {
+            ++stop;
+        }
+        advanceTo(stop);
+        return makeToken(TokenType::ILLEGAL);
     }
     
     advance(); // 跳过结束的单引号
-    return makeToken(TokenType::CHAR, std::string(1, value));
+    if (diagnostics_.size() != reported) {
+        return makeToken(TokenType::ILLEGAL);
+    }
+    if (has_escape) {
+        return makeDecodedToken(TokenType::CHAR, std::string_view(&value, 1));
+    }
+    return makeToken(TokenType::CHAR, std::string_view(source_code_).substr(content_start, 1));
 }
 
 char Lexical::processEscapeSequence() {
     if (isAtEnd()) {
-        throwError(_("Invalid escape sequence"), '\\', "ESCAPE");
+        reportError(LexicalErrorCode::INVALID_ESCAPE, '\\');
+        return '\\';
     }
     
     char c = currentChar();
@@ -454,7 +758,8 @@ char Lexical::processEscapeSequence() {
         case '"': return '"';
         case '0': return '\0';
         default:
-            throwError(_("Invalid escape sequence"), c, "ESCAPE");
+            // 恢复模式下保留原字符，所在的字面量整体成为 ILLEGAL Token
+            reportError(LexicalErrorCode::INVALID_ESCAPE, c);
             return c;
     }
 }
@@ -475,17 +780,123 @@ bool Lexical::isAlphaNumeric(char c) {
     return isAlpha(c) || isDigit(c);
 }
 
-bool Lexical::isKeyword(const std::string& text) {
-    return keywords_.find(text) != keywords_.end();
+Token Lexical::makeToken(TokenType type) const {
+    return makeToken(type, std::string_view(source_code_).substr(token_start_, index_ - token_start_));
+}
+
+Token Lexical::makeWordToken(TokenType type) const {
+    Token token = makeToken(type);
+    if (type == TokenType::IDENT && options_.symbols != nullptr && !discard_values_) {
+        token.symbol_ = options_.symbols->intern(token.getValue());
+    }
+    return token;
+}
+
+Token Lexical::makeToken(TokenType type, std::string_view value) const {
+    return Token::borrowed(type, value, tokenLine(), base_offset_ + token_start_);
+}
+
+Token Lexical::makeIntegerToken(uint64_t value, bool overflow) {
+    if (overflow || value > INT64_LIMIT) {
+        reportErrorAt(token_start_, LexicalErrorCode::NUMBER_OUT_OF_RANGE, '\0');
+        return makeToken(TokenType::ILLEGAL);
+    }
+    Token token = makeToken(TokenType::NUMBER);
+    token.number_form_ = NumberForm::INTEGER;
+    token.number_.integer = static_cast<int64_t>(value);
+    return token;
+}
+
+Token Lexical::makeDecimalToken(uint64_t mantissa, size_t digits, int64_t exponent, bool is_float) {
+    if (!is_float) {
+        return makeIntegerToken(mantissa, digits > MAX_EXACT_DIGITS);
+    }
+
+    double value;
+    if (EXACT_DOUBLE_ARITHMETIC && digits <= MAX_EXACT_DIGITS && mantissa <= MAX_EXACT_MANTISSA &&
+        exponent >= -MAX_EXACT_POWER && exponent <= MAX_EXACT_POWER) {
+        // 尾数和 10 的幂都能精确表示为 double，一次乘除的结果就是正确舍入的
+        value = static_cast<double>(mantissa);
+        value = exponent < 0 ? value / POWERS_OF_TEN[-exponent] : value * POWERS_OF_TEN[exponent];
+    } else if (!parseFloat(std::string_view(source_code_).substr(token_start_, index_ - token_start_), value)) {
+        // 超出 double 范围：第一个有效数字在小数点前则是上溢，否则是下溢
+        if (static_cast<int64_t>(digits) + exponent > 0) {
+            reportErrorAt(token_start_, LexicalErrorCode::NUMBER_OUT_OF_RANGE, '\0');
+            return makeToken(TokenType::ILLEGAL);
+        }
+        value = 0.0;
+    }
+
+    Token token = makeToken(TokenType::NUMBER);
+    token.number_form_ = NumberForm::FLOAT;
+    token.number_.real = value;
+    return token;
+}
+
+Token Lexical::makeDecodedToken(TokenType type, std::string_view value) const {
+    if (discard_values_) {
+        return makeToken(type);
+    }
+    if (value_resource_ != nullptr) {
+        return Token::borrowed(type, storeValue(value_resource_, value), tokenLine(), base_offset_ + token_start_);
+    }
+    // 只拷贝值本身，decoded_ 保留容量供下一个字面量使用
+    Token token(type, tokenLine(), base_offset_ + token_start_);
+    token.assignOwned(value);
+    return token;
+}
+
+std::string_view Lexical::storeValue(std::pmr::memory_resource* resource, std::string_view value) {
+    if (value.empty()) {
+        return {};
+    }
+    char* storage = static_cast<char*>(resource->allocate(value.size(), alignof(char)));
+    std::memcpy(storage, value.data(), value.size());
+    return {storage, value.size()};
+}
+
+void Lexical::reportError(LexicalErrorCode code, char error_char) {
+    reportErrorAt(index_, code, error_char);
 }
 
-Token Lexical::makeToken(TokenType type, const std::string& value) const {
-    return {type, value, line_};
+void Lexical::reportErrorAt(size_t position, LexicalErrorCode code, char error_char) {
+    Diagnostic diagnostic;
+    diagnostic.code = code;
+    diagnostic.offset = base_offset_ + position;
+    if (!options_.track_positions) {
+        diagnostic.line = lineOf(position);
+        diagnostic.column = columnOf(position);
+    } else if (position >= line_start_) {
+        diagnostic.line = line_;
+        diagnostic.column = static_cast<int>(position - line_start_) + 1;
+    } else {
+        // 位置在当前行之前，只可能位于当前Token内（如跨行Token的起点），按Token的起始行计算
+        diagnostic.line = token_line_;
+        diagnostic.column = static_cast<int>(position - token_line_start_) + 1;
+    }
+    diagnostic.character = error_char;
+    if (!recovering()) {
+        DREAMLANG_THROW(LexicalException(diagnostic));
+    }
+    diagnostics_.push_back(diagnostic);
+    if (options_.max_errors != 0 && diagnostics_.size() >= options_.max_errors) {
+        stopped_ = true;
+    }
+}
+
+void Lexical::skipIllegalCharacter() {
+    size_t next = index_ + 1;
+    while (next < source_code_.size() && (static_cast<unsigned char>(source_code_[next]) & 0xC0) == 0x80) {
+        ++next;
+    }
+    advanceTo(next);
 }
 
-void Lexical::throwError(const std::string& error_type, char error_char, 
-                        const std::string& token_type) const {
-    throw LexicalException(error_type, error_char, token_type, line_, column_);
+Token Lexical::recoverIllegalWord() {
+    while (!isAtEnd() && isAlphaNumeric(currentChar())) {
+        advance();
+    }
+    return makeToken(TokenType::ILLEGAL);
 }
 
 } // namespace dreamlang::lexer
@@ -9,7 +9,7 @@ LexicalException::LexicalException(const std::string& error_type,
                                  const std::string& error_token_type,
                                  int line,
                                  int column)
-    : std::runtime_error(generateMessage()),
+    : std::runtime_error(generateMessage(error_type, error_char, error_token_type, line, column)),
       error_type_(error_type),
       error_char_(error_char),
       error_token_type_(error_token_type),
@@ -26,21 +26,30 @@ LexicalException::LexicalException(const std::string& message, int line, int col
       column_(column) {
 }
 
-std::string LexicalException::generateMessage() const {
+LexicalException::LexicalException(const Diagnostic& diagnostic)
+    : LexicalException(_(lexicalErrorMessage(diagnostic.code)), diagnostic.character,
+                       lexicalErrorTokenType(diagnostic.code), diagnostic.line, diagnostic.column) {
+}
+
+std::string LexicalException::generateMessage(const std::string& error_type,
+                                              char error_char,
+                                              const std::string& error_token_type,
+                                              int line,
+                                              int column) {
     std::ostringstream oss;
     
-    if (column_ >= 0) {
-        oss << error_type_ << " at line " << line_ << ", column " << column_;
+    if (column >= 0) {
+        oss << error_type << " at line " << line << ", column " << column;
     } else {
-        oss << error_type_ << " at line " << line_;
+        oss << error_type << " at line " << line;
     }
     
-    if (error_char_ != '\0') {
-        oss << ": unexpected character '" << error_char_ << "'";
+    if (error_char != '\0') {
+        oss << ": unexpected character '" << error_char << "'";
     }
     
-    if (!error_token_type_.empty()) {
-        oss << " (token type: " << error_token_type_ << ")";
+    if (!error_token_type.empty()) {
+        oss << " (token type: " << error_token_type << ")";
     }
     
     return oss.str();
@@ -0,0 +1,159 @@
+#include "lexer/lexical.h"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+// 编辑后的增量词法分析
+//
+// 词法分析器在Token起点处没有除位置和行号以外的状态，因此：
+// 1. 换行Token之后总是一个干净的起点，换行符本身不依赖前后文，只要它不在编辑范围内，
+//    从它之后开始分析与从头分析的结果相同，起始行号是换行Token记录的行号加一；
+// 2. 新Token的起点位于编辑之后、且旧Token列表在对应位置也有一个Token起点时，
+//    两边此后看到的输入完全相同，产生的Token也必然相同，可以停止分析，直接复用旧Token。
+
+namespace dreamlang::lexer {
+
+namespace {
+
+/**
+ * 以增量分析需要的接口只读访问 std::vector<Token>（SegmentedTokens 提供同样的接口）
+ */
+class VectorTokens {
+public:
+    explicit VectorTokens(const std::vector<Token>& tokens) : tokens_(tokens) {}
+
+    size_t size() const { return tokens_.size(); }
+    size_t offsetAt(size_t index) const { return tokens_[index].getOffset(); }
+    int lineAt(size_t index) const { return tokens_[index].getLine(); }
+    TokenType typeAt(size_t index) const { return tokens_[index].getType(); }
+
+    size_t lowerBound(size_t offset) const {
+        auto it = std::lower_bound(tokens_.begin(), tokens_.end(), offset, [](const Token& token, size_t value) {
+            return token.getOffset() < value;
+        });
+        return it - tokens_.begin();
+    }
+
+private:
+    const std::vector<Token>& tokens_;
+};
+
+} // namespace
+
+template <typename OldTokens>
+Lexical::Relexed Lexical::relexEdit(const OldTokens& tokens, const TextEdit& edit) {
+    Relexed result;
+    result.delta = static_cast<std::ptrdiff_t>(edit.new_length) - static_cast<std::ptrdiff_t>(edit.old_length);
+    const size_t new_edit_end = edit.offset + edit.new_length;
+
+    // 找到编辑位置之前最近的换行Token，从它之后开始重新分析
+    size_t first = tokens.lowerBound(edit.offset);
+    while (first > 0 && tokens.typeAt(first - 1) != TokenType::LINEBREAK) {
+        --first;
+    }
+    size_t start = first > 0 ? tokens.offsetAt(first - 1) + 1 : 0;
+    int start_line = first > 0 ? tokens.lineAt(first - 1) + 1 : 1;
+    result.first = first;
+    result.resync = tokens.size();
+
+    // 重新分析直到与旧Token对齐
+    seek(start, start_line);
+    size_t old_index = first;
+    while (true) {
+        Token token = nextToken();
+        if (token.getOffset() >= new_edit_end) {
+            size_t old_offset = token.getOffset() - result.delta;
+            while (old_index < tokens.size() && tokens.offsetAt(old_index) < old_offset) {
+                ++old_index;
+            }
+            if (old_index < tokens.size() && tokens.offsetAt(old_index) == old_offset &&
+                tokens.typeAt(old_index) == token.getType()) {
+                result.resync = old_index;
+                result.line_delta = token.getLine() - tokens.lineAt(old_index);
+                break;
+            }
+        }
+        bool at_end = token.getType() == TokenType::EOF_TOKEN;
+        result.fresh.push_back(std::move(token));
+        if (at_end) {
+            break;
+        }
+    }
+    return result;
+}
+
+TokenSplice Lexical::retokenize(std::vector<Token>& tokens, const TextEdit& edit) {
+    if (edit.offset + edit.new_length > source_code_.size()) {
+        DREAMLANG_THROW(std::out_of_range("edit is outside of the source"));
+    }
+    if (tokens.empty()) {
+        reset();
+        tokens = tokenize();
+        return {0, 0, tokens.size()};
+    }
+
+    // 出错时 tokens 保持不变
+    Relexed relexed = relexEdit(VectorTokens(tokens), edit);
+    const size_t first = relexed.first;
+    const size_t resync = relexed.resync;
+    std::vector<Token>& fresh = relexed.fresh;
+
+    // 替换 [first, resync) 之间的Token；数量相同的部分就地赋值，只对差额移动后面的元素
+    size_t replaced = resync - first;
+    size_t common = std::min(replaced, fresh.size());
+    std::move(fresh.begin(), fresh.begin() + common, tokens.begin() + first);
+    if (fresh.size() > replaced) {
+        tokens.insert(tokens.begin() + resync, std::make_move_iterator(fresh.begin() + common),
+                      std::make_move_iterator(fresh.end()));
+    } else {
+        tokens.erase(tokens.begin() + first + common, tokens.begin() + resync);
+    }
+
+    // 之前的Token位置不变，只有源码缓冲区移动了（VIEW 模式下）才需要重新指向新源码；
+    // OWNED 模式下不持有值的只有引用驻留表的标识符，无需改变
+    std::string_view source = source_code_;
+    const bool rebind = options_.value_mode == TokenValueMode::VIEW;
+    if (rebind) {
+        // 它们都指向同一份源码，检查第一个不持有值的Token即可
+        auto bound = std::find_if(tokens.begin(), tokens.begin() + first, [](const Token& token) {
+            return !token.ownsValue();
+        });
+        if (bound != tokens.begin() + first) {
+            Token rebound = *bound;
+            rebound.shift(0, 0, source, true);
+            if (rebound.getValue().data() != bound->getValue().data()) {
+                for (size_t i = 0; i < first; ++i) {
+                    tokens[i].shift(0, 0, source, true);
+                }
+            }
+        }
+    }
+    // 之后的Token逐个平移，代价与其数量成正比；大文件的频繁编辑应使用 SegmentedTokens
+    for (size_t i = first + fresh.size(); i < tokens.size(); ++i) {
+        tokens[i].shift(relexed.delta, relexed.line_delta, source, rebind);
+    }
+    return {first, replaced, fresh.size()};
+}
+
+TokenSplice Lexical::retokenize(SegmentedTokens& tokens, const TextEdit& edit) {
+    if (edit.offset + edit.new_length > source_code_.size()) {
+        DREAMLANG_THROW(std::out_of_range("edit is outside of the source"));
+    }
+    if (tokens.empty()) {
+        reset();
+        tokenizeInto(tokens);
+        return {0, 0, tokens.size()};
+    }
+
+    Relexed relexed = relexEdit(tokens, edit);
+    TokenSplice splice{relexed.first, relexed.resync - relexed.first, relexed.fresh.size()};
+    tokens.splice(relexed.first, relexed.resync, std::move(relexed.fresh), relexed.delta, relexed.line_delta,
+                  source_code_);
+    return splice;
+}
+
+void Lexical::tokenizeInto(SegmentedTokens& tokens) {
+    tokens.assign(tokenize(), source_code_, options_.value_mode == TokenValueMode::VIEW);
+}
+
+} // namespace dreamlang::lexer
@@ -0,0 +1,201 @@
+#include "lexer/lexical.h"
+#include "lexer/simd_scan.h"
+#include <algorithm>
+#include <thread>
+
+// 单个文件的并行词法分析
+//
+// 1. 在换行符之后把源码切成若干块，并行统计每块的换行数，得到每块起始行号；
+// 2. 每块从块首按"不在字符串或注释中"的假设并行推测分析，记录每个Token的结束位置；
+// 3. 顺序校正：维护真实的Token边界 pos，若 pos 恰为某块的起点或该块某个Token的结束位置，
+//    则该块此后的推测结果与串行分析必然一致（词法分析器在Token边界处没有其他状态），可直接拼接；
+//    否则从 pos 串行分析，直到与推测结果重新对齐。真实的词法错误由串行分析抛出（恢复模式下记录），
+//    因此与 tokenize() 一致。
+
+namespace dreamlang::lexer {
+
+namespace {
+
+// 每个线程至少处理的字节数，太小的输入直接串行分析
+constexpr size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+/**
+ * 单个块的推测分析结果
+ */
+struct ChunkResult {
+    size_t begin = 0;
+    size_t end = 0;
+    int first_line = 1;
+    std::vector<Token> tokens;
+    // tokens[i] 结束时的位置，严格递增
+    std::vector<size_t> token_ends;
+    // 推测分析停止的位置（最后一个有效Token之后）
+    size_t stop = 0;
+};
+
+template<typename Function>
+void runParallel(size_t count, Function function) {
+    std::vector<std::thread> workers;
+    workers.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        workers.emplace_back(function, i);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+} // namespace
+
+std::vector<Token> Lexical::tokenizeParallel(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const size_t size = source_code_.size();
+    const char* const base = source_code_.data();
+
+    // 总是从头开始：清除上一次分析留下的诊断信息和 max_errors 停止状态
+    reset();
+
+    size_t chunk_count = std::min<size_t>(threads, size / MIN_CHUNK_SIZE);
+    if (chunk_count <= 1) {
+        return tokenize();
+    }
+
+    // 块从行首开始，行号只由块前的换行数决定
+    std::vector<ChunkResult> chunks;
+    chunks.reserve(chunk_count);
+    size_t begin = 0;
+    for (size_t i = 1; i <= chunk_count; ++i) {
+        size_t end = size;
+        if (i < chunk_count) {
+            const char* newline = simd::findNewline(base + std::max(begin, size * i / chunk_count), base + size);
+            end = newline == base + size ? size : newline - base + 1;
+        }
+        if (end > begin) {
+            ChunkResult chunk;
+            chunk.begin = begin;
+            chunk.end = end;
+            chunks.push_back(std::move(chunk));
+            begin = end;
+        }
+    }
+
+    // 延迟计算位置时Token不记录行号，无需统计
+    if (options_.track_positions) {
+        std::vector<size_t> newline_counts(chunks.size());
+        runParallel(chunks.size(), [&](size_t i) {
+            newline_counts[i] = simd::countNewlines(base + chunks[i].begin, base + chunks[i].end);
+        });
+        for (size_t i = 1; i < chunks.size(); ++i) {
+            chunks[i].first_line = chunks[i - 1].first_line + static_cast<int>(newline_counts[i - 1]);
+        }
+    }
+
+    // 推测分析在恢复模式下进行，遇到第一个错误就停止；
+    // 起始状态错误的块会产生无效的标识符，因此不驻留，被采用的Token在校正时按顺序驻留
+    LexerOptions speculative = options_;
+    speculative.recover_errors = true;
+    speculative.max_errors = 1;
+    speculative.symbols = nullptr;
+    runParallel(chunks.size(), [&](size_t i) {
+        ChunkResult& chunk = chunks[i];
+        Lexical lexer(source_code_, speculative, BorrowedSource{});
+        lexer.seek(chunk.begin, chunk.first_line);
+        while (lexer.index_ < chunk.end) {
+            Token token = lexer.nextToken();
+            if (!lexer.diagnostics_.empty() || token.getType() == TokenType::EOF_TOKEN) {
+                break;
+            }
+            chunk.tokens.push_back(std::move(token));
+            chunk.token_ends.push_back(lexer.index_);
+        }
+        if (lexer.diagnostics_.empty()) {
+            chunk.stop = lexer.index_;
+        } else {
+            // 推测的起始状态可能是错的，出错时只保留之前的Token，交给顺序校正处理
+            chunk.stop = chunk.token_ends.empty() ? chunk.begin : chunk.token_ends.back();
+        }
+    });
+
+    // 顺序校正块边界
+    std::vector<Token> tokens;
+    size_t total = 0;
+    for (const auto& chunk : chunks) {
+        total += chunk.tokens.size();
+    }
+    tokens.reserve(total + 1);
+
+    auto lineAt = [&](size_t position) {
+        if (!options_.track_positions) {
+            return 0;
+        }
+        auto chunk = std::upper_bound(chunks.begin(), chunks.end(), position,
+                                      [](size_t p, const ChunkResult& c) { return p < c.begin; }) - 1;
+        return chunk->first_line + static_cast<int>(simd::countNewlines(base + chunk->begin, base + position));
+    };
+
+    // position 是已确认的Token边界；synced 表示本对象的状态已位于 position
+    size_t position = 0;
+    bool synced = false;
+    for (auto& chunk : chunks) {
+        size_t first = 0;
+        bool aligned = position == chunk.begin;
+        while (!aligned && position < chunk.stop) {
+            auto it = std::lower_bound(chunk.token_ends.begin(), chunk.token_ends.end(), position);
+            if (it != chunk.token_ends.end() && *it == position) {
+                first = it - chunk.token_ends.begin() + 1;
+                aligned = true;
+                break;
+            }
+            // 串行分析一个Token；遇到真实的词法错误时在这里抛出或记录
+            if (!synced) {
+                seek(position, lineAt(position));
+                synced = true;
+            }
+            Token token = nextToken();
+            if (token.getType() == TokenType::EOF_TOKEN) {
+                tokens.push_back(std::move(token));
+                return tokens;
+            }
+            tokens.push_back(std::move(token));
+            position = index_;
+        }
+        if (!aligned) {
+            continue;
+        }
+        for (size_t i = first; i < chunk.tokens.size(); ++i) {
+            adoptSpeculative(chunk.tokens[i]);
+            tokens.push_back(std::move(chunk.tokens[i]));
+        }
+        position = chunk.stop;
+        synced = false;
+    }
+
+    // 剩余部分（通常只剩EOF，或最后一块出错后的真实错误）串行完成
+    if (!synced) {
+        seek(position, lineAt(position));
+    }
+    while (true) {
+        Token token = nextToken();
+        bool at_end = token.getType() == TokenType::EOF_TOKEN;
+        tokens.push_back(std::move(token));
+        if (at_end) {
+            break;
+        }
+    }
+    return tokens;
+}
+
+void Lexical::adoptSpeculative(Token& token) const {
+    if (options_.symbols == nullptr || token.getType() != TokenType::IDENT) {
+        return;
+    }
+    token.symbol_ = options_.symbols->intern(token.getValue());
+    if (options_.value_mode == TokenValueMode::OWNED) {
+        // 与 nextToken() 相同，标识符的名字只在驻留表中保存一份
+        token.assignBorrowed(options_.symbols->text(token.symbol_));
+    }
+}
+
+} // namespace dreamlang::lexer
@@ -0,0 +1,443 @@
+#include "lexer/lexical.h"
+#include "lexer/keyword_table.h"
+#include "lexer/simd_scan.h"
+#include <cstdint>
+
+// 表驱动的词法分析后端
+//
+// 每个字节先通过 256 项的字符类别表映射为类别，再由 (状态, 类别) 查转移表，
+// 得到下一个状态或一个动作。标识符和数字的主体用专门的循环扫描，每个字节同样只查一次表；
+// 字符串主体与 switch 后端共用按块扫描的实现。源码末尾的 '\0' 作为哨兵，扫描时不做逐字节的边界检查。
+
+namespace dreamlang::lexer {
+
+namespace {
+
+/**
+ * 字符类别，标识符可以包含的类别排在最前面
+ */
+enum CharClass : uint8_t {
+    CC_ALPHA,
+    CC_DIGIT,
+    CC_BLANK,
+    CC_NEWLINE,
+    CC_QUOTE,
+    CC_APOSTROPHE,
+    CC_BACKSLASH,
+    CC_SLASH,
+    CC_STAR,
+    CC_EQUAL,
+    CC_BANG,
+    CC_LESS,
+    CC_GREATER,
+    CC_AMPERSAND,
+    CC_PIPE,
+    CC_PLUS,
+    CC_MINUS,
+    CC_PERCENT,
+    CC_DOT,
+    CC_COMMA,
+    CC_COLON,
+    CC_SEMICOLON,
+    CC_LEFT_PAREN,
+    CC_RIGHT_PAREN,
+    CC_LEFT_BRACKET,
+    CC_RIGHT_BRACKET,
+    CC_LEFT_BRACE,
+    CC_RIGHT_BRACE,
+    CC_NUL,
+    CC_OTHER,
+    CC_COUNT
+};
+
+/**
+ * 扫描状态，记录已读入的操作符前缀
+ */
+enum State : uint8_t {
+    ST_START,
+    ST_EQUAL,
+    ST_BANG,
+    ST_LESS,
+    ST_GREATER,
+    ST_AMPERSAND,
+    ST_PIPE,
+    ST_STAR,
+    ST_SLASH,
+    ST_COUNT
+};
+
+// 转移表中的值：小于 ACTION_EMIT 的是下一个状态（并消耗当前字节）；
+// ACTION_EMIT + 类型表示消耗当前字节后产生该类型的Token；
+// ACTION_EMIT_BEFORE + 类型表示不消耗当前字节直接产生Token；
+// 其余是交给专门扫描例程的动作
+constexpr uint8_t ACTION_EMIT = 0x40;
+constexpr uint8_t ACTION_EMIT_BEFORE = 0x80;
+constexpr uint8_t ACTION_SPECIAL = 0xC0;
+
+enum SpecialAction : uint8_t {
+    ACT_IDENT = ACTION_SPECIAL,
+    ACT_NUMBER,
+    ACT_STRING,
+    ACT_CHAR,
+    ACT_BLANK,
+    ACT_NEWLINE,
+    ACT_LINE_COMMENT,
+    ACT_BLOCK_COMMENT,
+    ACT_END,
+    ACT_UNEXPECTED,
+    ACT_INVALID
+};
+
+static_assert(static_cast<int>(TokenType::EOF_TOKEN) < ACTION_EMIT, "token types must fit in the action encoding");
+
+constexpr uint8_t emit(TokenType type) {
+    return static_cast<uint8_t>(ACTION_EMIT + static_cast<uint8_t>(type));
+}
+
+constexpr uint8_t emitBefore(TokenType type) {
+    return static_cast<uint8_t>(ACTION_EMIT_BEFORE + static_cast<uint8_t>(type));
+}
+
+struct CharClassTable {
+    uint8_t classes[256] = {};
+};
+
+constexpr CharClassTable buildCharClassTable() {
+    CharClassTable table;
+    for (int c = 0; c < 256; ++c) {
+        table.classes[c] = CC_OTHER;
+    }
+    for (int c = 'a'; c <= 'z'; ++c) {
+        table.classes[c] = CC_ALPHA;
+    }
+    for (int c = 'A'; c <= 'Z'; ++c) {
+        table.classes[c] = CC_ALPHA;
+    }
+    for (int c = '0'; c <= '9'; ++c) {
+        table.classes[c] = CC_DIGIT;
+    }
+    table.classes[static_cast<unsigned char>('_')] = CC_ALPHA;
+    table.classes[static_cast<unsigned char>(' ')] = CC_BLANK;
+    table.classes[static_cast<unsigned char>('\t')] = CC_BLANK;
+    table.classes[static_cast<unsigned char>('\r')] = CC_BLANK;
+    table.classes[static_cast<unsigned char>('\n')] = CC_NEWLINE;
+    table.classes[static_cast<unsigned char>('"')] = CC_QUOTE;
+    table.classes[static_cast<unsigned char>('\'')] = CC_APOSTROPHE;
+    table.classes[static_cast<unsigned char>('\\')] = CC_BACKSLASH;
+    table.classes[static_cast<unsigned char>('/')] = CC_SLASH;
+    table.classes[static_cast<unsigned char>('*')] = CC_STAR;
+    table.classes[static_cast<unsigned char>('=')] = CC_EQUAL;
+    table.classes[static_cast<unsigned char>('!')] = CC_BANG;
+    table.classes[static_cast<unsigned char>('<')] = CC_LESS;
+    table.classes[static_cast<unsigned char>('>')] = CC_GREATER;
+    table.classes[static_cast<unsigned char>('&')] = CC_AMPERSAND;
+    table.classes[static_cast<unsigned char>('|')] = CC_PIPE;
+    table.classes[static_cast<unsigned char>('+')] = CC_PLUS;
+    table.classes[static_cast<unsigned char>('-')] = CC_MINUS;
+    table.classes[static_cast<unsigned char>('%')] = CC_PERCENT;
+    table.classes[static_cast<unsigned char>('.')] = CC_DOT;
+    table.classes[static_cast<unsigned char>(',')] = CC_COMMA;
+    table.classes[static_cast<unsigned char>(':')] = CC_COLON;
+    table.classes[static_cast<unsigned char>(';')] = CC_SEMICOLON;
+    table.classes[static_cast<unsigned char>('(')] = CC_LEFT_PAREN;
+    table.classes[static_cast<unsigned char>(')')] = CC_RIGHT_PAREN;
+    table.classes[static_cast<unsigned char>('[')] = CC_LEFT_BRACKET;
+    table.classes[static_cast<unsigned char>(']')] = CC_RIGHT_BRACKET;
+    table.classes[static_cast<unsigned char>('{')] = CC_LEFT_BRACE;
+    table.classes[static_cast<unsigned char>('}')] = CC_RIGHT_BRACE;
+    table.classes[0] = CC_NUL;
+    return table;
+}
+
+/**
+ * 数字字符的值（支持到十六进制），其他字符为 0xFF
+ */
+struct DigitValueTable {
+    uint8_t values[256] = {};
+};
+
+constexpr DigitValueTable buildDigitValueTable() {
+    DigitValueTable table;
+    for (int c = 0; c < 256; ++c) {
+        table.values[c] = 0xFF;
+    }
+    for (int c = '0'; c <= '9'; ++c) {
+        table.values[c] = static_cast<uint8_t>(c - '0');
+    }
+    for (int c = 'a'; c <= 'f'; ++c) {
+        table.values[c] = static_cast<uint8_t>(c - 'a' + 10);
+        table.values[c - 'a' + 'A'] = static_cast<uint8_t>(c - 'a' + 10);
+    }
+    return table;
+}
+
+struct TransitionTable {
+    uint8_t next[ST_COUNT][CC_COUNT] = {};
+};
+
+constexpr TransitionTable buildTransitionTable() {
+    TransitionTable table;
+
+    // 起始状态
+    uint8_t* start = table.next[ST_START];
+    start[CC_ALPHA] = ACT_IDENT;
+    start[CC_DIGIT] = ACT_NUMBER;
+    start[CC_BLANK] = ACT_BLANK;
+    start[CC_NEWLINE] = ACT_NEWLINE;
+    start[CC_QUOTE] = ACT_STRING;
+    start[CC_APOSTROPHE] = ACT_CHAR;
+    start[CC_BACKSLASH] = ACT_UNEXPECTED;
+    start[CC_SLASH] = ST_SLASH;
+    start[CC_STAR] = ST_STAR;
+    start[CC_EQUAL] = ST_EQUAL;
+    start[CC_BANG] = ST_BANG;
+    start[CC_LESS] = ST_LESS;
+    start[CC_GREATER] = ST_GREATER;
+    start[CC_AMPERSAND] = ST_AMPERSAND;
+    start[CC_PIPE] = ST_PIPE;
+    start[CC_PLUS] = emit(TokenType::PLUS);
+    start[CC_MINUS] = emit(TokenType::MINUS);
+    start[CC_PERCENT] = emit(TokenType::MODULO);
+    start[CC_DOT] = emit(TokenType::DOT);
+    start[CC_COMMA] = emit(TokenType::COMMA);
+    start[CC_COLON] = emit(TokenType::COLON);
+    start[CC_SEMICOLON] = emit(TokenType::SEMICOLON);
+    start[CC_LEFT_PAREN] = emit(TokenType::LEFT_PAREN);
+    start[CC_RIGHT_PAREN] = emit(TokenType::RIGHT_PAREN);
+    start[CC_LEFT_BRACKET] = emit(TokenType::LEFT_BRACKET);
+    start[CC_RIGHT_BRACKET] = emit(TokenType::RIGHT_BRACKET);
+    start[CC_LEFT_BRACE] = emit(TokenType::LEFT_BRACE);
+    start[CC_RIGHT_BRACE] = emit(TokenType::RIGHT_BRACE);
+    start[CC_NUL] = ACT_END;
+    start[CC_OTHER] = ACT_UNEXPECTED;
+
+    // 操作符的第二个字符：匹配时消耗并产生双字符Token，否则产生单字符Token
+    struct Pair {
+        State state;
+        CharClass second;
+        TokenType single;
+        TokenType twice;
+    };
+    const Pair pairs[] = {
+        {ST_EQUAL, CC_EQUAL, TokenType::ASSIGN, TokenType::EQUAL},
+        {ST_BANG, CC_EQUAL, TokenType::LOGICAL_NOT, TokenType::NOT_EQUAL},
+        {ST_LESS, CC_EQUAL, TokenType::LESS, TokenType::LESS_EQUAL},
+        {ST_GREATER, CC_EQUAL, TokenType::GREATER, TokenType::GREATER_EQUAL},
+        {ST_STAR, CC_STAR, TokenType::MULT, TokenType::POWER},
+    };
+    for (const auto& pair : pairs) {
+        for (int cls = 0; cls < CC_COUNT; ++cls) {
+            table.next[pair.state][cls] = emitBefore(pair.single);
+        }
+        table.next[pair.state][pair.second] = emit(pair.twice);
+    }
+
+    // & 和 | 只能成对出现
+    for (int cls = 0; cls < CC_COUNT; ++cls) {
+        table.next[ST_AMPERSAND][cls] = ACT_INVALID;
+        table.next[ST_PIPE][cls] = ACT_INVALID;
+    }
+    table.next[ST_AMPERSAND][CC_AMPERSAND] = emit(TokenType::LOGICAL_AND);
+    table.next[ST_PIPE][CC_PIPE] = emit(TokenType::LOGICAL_OR);
+
+    // / 可能是除号或注释的开始
+    for (int cls = 0; cls < CC_COUNT; ++cls) {
+        table.next[ST_SLASH][cls] = emitBefore(TokenType::DIVIDE);
+    }
+    table.next[ST_SLASH][CC_SLASH] = ACT_LINE_COMMENT;
+    table.next[ST_SLASH][CC_STAR] = ACT_BLOCK_COMMENT;
+
+    return table;
+}
+
+constexpr CharClassTable CHAR_CLASSES = buildCharClassTable();
+constexpr DigitValueTable DIGIT_VALUES = buildDigitValueTable();
+constexpr TransitionTable TRANSITIONS = buildTransitionTable();
+
+inline uint8_t charClass(const char* p) {
+    return CHAR_CLASSES.classes[static_cast<unsigned char>(*p)];
+}
+
+inline uint8_t digitValue(const char* p) {
+    return DIGIT_VALUES.values[static_cast<unsigned char>(*p)];
+}
+
+} // namespace
+
+Token Lexical::scanTokenTable() {
+    const char* const base = source_code_.data();
+    const char* const end = base + source_code_.size();
+
+    while (true) {
+        beginToken();
+        const char* p = base + index_;
+        uint8_t state = ST_START;
+        uint8_t action;
+
+        // 操作符前缀在状态机内推进，其余情况在第一个字节处就转给专门的例程
+        while ((action = TRANSITIONS.next[state][charClass(p)]) < ACTION_EMIT) {
+            state = action;
+            ++p;
+        }
+
+        if (action < ACTION_EMIT_BEFORE) {
+            advanceTo(p + 1 - base);
+            return makeToken(static_cast<TokenType>(action - ACTION_EMIT));
+        }
+        if (action < ACTION_SPECIAL) {
+            advanceTo(p - base);
+            return makeToken(static_cast<TokenType>(action - ACTION_EMIT_BEFORE));
+        }
+
+        switch (action) {
+            case ACT_IDENT: {
+                ++p;
+                while (charClass(p) <= CC_DIGIT) {
+                    ++p;
+                }
+                advanceTo(p - base);
+                std::string_view text(base + token_start_, p - (base + token_start_));
+                return makeWordToken(lookupKeyword(text));
+            }
+
+            case ACT_NUMBER:
+                return readNumberTable();
+
+            case ACT_STRING:
+                // 字符串主体由通用实现按块扫描
+                return readString();
+
+            case ACT_CHAR:
+                // 字符字面量最多四个字节，直接复用通用实现
+                return readChar();
+
+            case ACT_BLANK:
+                p = simd::skipBlanks(p, end);
+                advanceTo(p - base);
+                continue;
+
+            case ACT_NEWLINE:
+                advance();
+                return makeToken(TokenType::LINEBREAK);
+
+            case ACT_LINE_COMMENT:
+                skipSingleLineComment();
+                continue;
+
+            case ACT_BLOCK_COMMENT:
+                if (!skipMultiLineComment()) {
+                    return makeToken(TokenType::ILLEGAL);
+                }
+                continue;
+
+            case ACT_END:
+                if (p == end) {
+                    return makeToken(TokenType::EOF_TOKEN);
+                }
+                reportError(LexicalErrorCode::UNEXPECTED_CHARACTER, *p);
+                skipIllegalCharacter();
+                return makeToken(TokenType::ILLEGAL);
+
+            case ACT_INVALID:
+                // 与 switch 后端一致：错误位置在 & 或 | 之后
+                advanceTo(p - base);
+                reportError(LexicalErrorCode::INVALID_CHARACTER, p[-1]);
+                return makeToken(TokenType::ILLEGAL);
+
+            case ACT_UNEXPECTED:
+            default:
+                reportError(LexicalErrorCode::UNEXPECTED_CHARACTER, *p);
+                skipIllegalCharacter();
+                return makeToken(TokenType::ILLEGAL);
+        }
+    }
+}
+
+Token Lexical::readNumberTable() {
+    const char* const base = source_code_.data();
+    const char* p = base + index_;
+
+    // 0x/0b/0o 前缀：p[0] 不是哨兵，所以 p[1] 可读
+    if (p[0] == '0') {
+        uint8_t radix = 0;
+        LexicalErrorCode error = LexicalErrorCode::INVALID_NUMBER_FORMAT;
+        switch (p[1]) {
+            case 'x': case 'X': radix = 16; error = LexicalErrorCode::INVALID_HEX_NUMBER; break;
+            case 'b': case 'B': radix = 2; error = LexicalErrorCode::INVALID_BINARY_NUMBER; break;
+            case 'o': case 'O': radix = 8; error = LexicalErrorCode::INVALID_OCTAL_NUMBER; break;
+            default: break;
+        }
+        if (radix != 0) {
+            p += 2;
+            uint8_t digit = digitValue(p);
+            if (digit >= radix) {
+                advanceTo(p - base);
+                reportError(error, *p);
+                return recoverIllegalWord();
+            }
+            // INT64_MAX 除以 2 的幂的余数是 radix - 1，value 不超过 limit 时再接一位数字不会超出 int64
+            const uint64_t limit = static_cast<uint64_t>(INT64_MAX) / radix;
+            uint64_t value = 0;
+            bool overflow = false;
+            do {
+                overflow |= value > limit;
+                value = value * radix + digit;
+                digit = digitValue(++p);
+            } while (digit < radix);
+            advanceTo(p - base);
+            return makeIntegerToken(value, overflow);
+        }
+    }
+
+    // 整数部分和小数部分的数字累加到同一个尾数中
+    uint64_t mantissa = 0;
+    size_t digits = 0;
+    int64_t exponent = 0;
+    bool is_float = false;
+    uint8_t digit;
+    while ((digit = digitValue(p)) < 10) {
+        mantissa = mantissa * 10 + digit;
+        digits += digits != 0 || digit != 0;
+        ++p;
+    }
+
+    // 小数部分：只有 '.' 后面紧跟数字时才属于数字
+    if (*p == '.' && digitValue(p + 1) < 10) {
+        is_float = true;
+        ++p;
+        while ((digit = digitValue(p)) < 10) {
+            mantissa = mantissa * 10 + digit;
+            digits += digits != 0 || digit != 0;
+            --exponent;
+            ++p;
+        }
+    }
+
+    // 科学计数法
+    if (*p == 'e' || *p == 'E') {
+        is_float = true;
+        ++p;
+        bool negative = *p == '-';
+        if (*p == '+' || *p == '-') {
+            ++p;
+        }
+        if (digitValue(p) >= 10) {
+            advanceTo(p - base);
+            reportError(LexicalErrorCode::INVALID_NUMBER_FORMAT, *p);
+            return recoverIllegalWord();
+        }
+        int64_t power = 0;
+        while ((digit = digitValue(p)) < 10) {
+            if (power < EXPONENT_LIMIT) {
+                power = power * 10 + digit;
+            }
+            ++p;
+        }
+        exponent += negative ? -power : power;
+    }
+
+    advanceTo(p - base);
+    return makeDecimalToken(mantissa, digits, exponent, is_float);
+}
+
+} // namespace dreamlang::lexer
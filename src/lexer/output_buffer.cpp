@@ -0,0 +1,102 @@
+#include "lexer/output_buffer.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace dreamlang::lexer {
+
+namespace {
+
+// 缓冲区的最小容量，保证整数等短文本总能放进空的缓冲区
+constexpr size_t MIN_CAPACITY = 64;
+
+} // namespace
+
+OutputBuffer::OutputBuffer(std::ostream& out, size_t capacity)
+    : stream_(&out), data_(new char[std::max(capacity, MIN_CAPACITY)]), capacity_(std::max(capacity, MIN_CAPACITY)) {
+}
+
+OutputBuffer::OutputBuffer(int fd, size_t capacity)
+    : fd_(fd), data_(new char[std::max(capacity, MIN_CAPACITY)]), capacity_(std::max(capacity, MIN_CAPACITY)) {
+}
+
+OutputBuffer::OutputBuffer(std::string& out, size_t capacity)
+    : string_(&out), data_(new char[std::max(capacity, MIN_CAPACITY)]), capacity_(std::max(capacity, MIN_CAPACITY)) {
+}
+
+OutputBuffer::~OutputBuffer() {
+    flush();
+}
+
+void OutputBuffer::writeInteger(int64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    write(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+}
+
+void OutputBuffer::fill(char c, size_t count) {
+    while (count != 0) {
+        if (size_ == capacity_) {
+            flush();
+        }
+        size_t length = std::min(count, capacity_ - size_);
+        std::memset(data_.get() + size_, c, length);
+        size_ += length;
+        count -= length;
+    }
+}
+
+void OutputBuffer::flush() {
+    if (size_ != 0) {
+        writeTarget(data_.get(), size_);
+        size_ = 0;
+    }
+}
+
+void OutputBuffer::writeLarge(std::string_view text) {
+    flush();
+    if (text.size() >= capacity_) {
+        // 比整个缓冲区还大的文本直接写入，不再经过缓冲区
+        writeTarget(text.data(), text.size());
+        return;
+    }
+    std::memcpy(data_.get(), text.data(), text.size());
+    size_ = text.size();
+}
+
+void OutputBuffer::writeTarget(const char* data, size_t size) {
+    if (stream_ != nullptr) {
+        stream_->write(data, static_cast<std::streamsize>(size));
+        return;
+    }
+    if (string_ != nullptr) {
+        string_->append(data, size);
+        return;
+    }
+
+    // 出错后丢弃后续输出，由 good() 报告
+    while (size != 0 && !failed_) {
+#ifdef _WIN32
+        auto count = ::_write(fd_, data, static_cast<unsigned>(std::min<size_t>(size, 1u << 30)));
+#else
+        ssize_t count = ::write(fd_, data, size);
+#endif
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            failed_ = true;
+            break;
+        }
+        data += count;
+        size -= static_cast<size_t>(count);
+    }
+}
+
+} // namespace dreamlang::lexer
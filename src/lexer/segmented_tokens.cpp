@@ -0,0 +1,176 @@
+#include "lexer/segmented_tokens.h"
+#include <algorithm>
+#include <iterator>
+
+namespace dreamlang::lexer {
+
+namespace {
+
+size_t shifted(size_t offset, std::ptrdiff_t delta) {
+    return static_cast<size_t>(static_cast<std::ptrdiff_t>(offset) + delta);
+}
+
+} // namespace
+
+const Token& SegmentedTokens::operator[](size_t index) {
+    Segment& segment = segments_[segmentOf(index)];
+    settle(segment);
+    return segment.tokens[index - segment.first_index];
+}
+
+std::vector<Token> SegmentedTokens::toVector() {
+    std::vector<Token> tokens;
+    tokens.reserve(size_);
+    for (Segment& segment : segments_) {
+        settle(segment);
+        tokens.insert(tokens.end(), segment.tokens.begin(), segment.tokens.end());
+    }
+    return tokens;
+}
+
+void SegmentedTokens::assign(std::vector<Token> tokens, std::string_view source, bool rebind) {
+    segments_.clear();
+    size_ = tokens.size();
+    source_ = source;
+    rebind_ = rebind;
+    last_segment_ = 0;
+    for (size_t begin = 0; begin < tokens.size(); begin += SEGMENT_SIZE) {
+        size_t end = std::min(begin + SEGMENT_SIZE, tokens.size());
+        Segment segment;
+        segment.tokens.assign(std::make_move_iterator(tokens.begin() + begin),
+                              std::make_move_iterator(tokens.begin() + end));
+        segment.first_index = begin;
+        segment.bound_source = source.data();
+        segments_.push_back(std::move(segment));
+    }
+}
+
+size_t SegmentedTokens::segmentOf(size_t index) const {
+    // 顺序访问时多半仍在上一次的段或紧随其后的段
+    for (size_t candidate = last_segment_; candidate < segments_.size() && candidate <= last_segment_ + 1;
+         ++candidate) {
+        const Segment& segment = segments_[candidate];
+        if (index >= segment.first_index && index < segment.first_index + segment.tokens.size()) {
+            last_segment_ = candidate;
+            return candidate;
+        }
+    }
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), index, [](size_t i, const Segment& segment) {
+        return i < segment.first_index;
+    });
+    last_segment_ = (it - segments_.begin()) - 1;
+    return last_segment_;
+}
+
+void SegmentedTokens::settle(Segment& segment) {
+    bool moved = rebind_ && segment.bound_source != source_.data();
+    if (segment.offset_delta == 0 && segment.line_delta == 0 && !moved) {
+        return;
+    }
+    for (Token& token : segment.tokens) {
+        token.shift(segment.offset_delta, segment.line_delta, source_, rebind_);
+    }
+    segment.offset_delta = 0;
+    segment.line_delta = 0;
+    segment.bound_source = source_.data();
+}
+
+size_t SegmentedTokens::offsetAt(size_t index) const {
+    const Segment& segment = segments_[segmentOf(index)];
+    return shifted(segment.tokens[index - segment.first_index].getOffset(), segment.offset_delta);
+}
+
+int SegmentedTokens::lineAt(size_t index) const {
+    const Segment& segment = segments_[segmentOf(index)];
+    return segment.tokens[index - segment.first_index].getLine() + segment.line_delta;
+}
+
+TokenType SegmentedTokens::typeAt(size_t index) const {
+    const Segment& segment = segments_[segmentOf(index)];
+    return segment.tokens[index - segment.first_index].getType();
+}
+
+size_t SegmentedTokens::lowerBound(size_t offset) const {
+    // 先找到第一个首Token偏移不小于 offset 的段，结果在它之前的那一段中或就是它的首Token
+    auto it = std::lower_bound(segments_.begin(), segments_.end(), offset, [](const Segment& segment, size_t value) {
+        return shifted(segment.tokens.front().getOffset(), segment.offset_delta) < value;
+    });
+    if (it == segments_.begin()) {
+        return 0;
+    }
+    const Segment& segment = *(it - 1);
+    auto token = std::lower_bound(segment.tokens.begin(), segment.tokens.end(), offset,
+                                  [&segment](const Token& t, size_t value) {
+                                      return shifted(t.getOffset(), segment.offset_delta) < value;
+                                  });
+    return segment.first_index + (token - segment.tokens.begin());
+}
+
+void SegmentedTokens::splice(size_t first, size_t resync, std::vector<Token>&& fresh, std::ptrdiff_t delta,
+                             int line_delta, std::string_view source) {
+    size_t begin_segment = segmentOf(std::min(first, size_ - 1));
+    size_t end_segment = resync < size_ ? segmentOf(resync) : segments_.size() - 1;
+
+    // 拼接结果太小时并入下一段，避免反复编辑后段越来越碎
+    size_t removed = resync - first;
+    size_t combined = segments_[end_segment].first_index + segments_[end_segment].tokens.size() -
+                      segments_[begin_segment].first_index - removed + fresh.size();
+    while (combined < SEGMENT_SIZE / 2 && end_segment + 1 < segments_.size()) {
+        ++end_segment;
+        combined += segments_[end_segment].tokens.size();
+    }
+
+    // 按顺序收集受影响段中保留的Token和新Token，同时应用积累的增量和本次编辑的平移
+    std::vector<Token> merged;
+    merged.reserve(combined);
+    for (size_t s = begin_segment; s <= end_segment; ++s) {
+        Segment& segment = segments_[s];
+        for (size_t k = 0; k < segment.tokens.size() && segment.first_index + k < first; ++k) {
+            segment.tokens[k].shift(segment.offset_delta, segment.line_delta, source, rebind_);
+            merged.push_back(std::move(segment.tokens[k]));
+        }
+    }
+    std::move(fresh.begin(), fresh.end(), std::back_inserter(merged));
+    for (size_t s = begin_segment; s <= end_segment; ++s) {
+        Segment& segment = segments_[s];
+        size_t k = resync > segment.first_index ? resync - segment.first_index : 0;
+        for (; k < segment.tokens.size(); ++k) {
+            segment.tokens[k].shift(segment.offset_delta + delta, segment.line_delta + line_delta, source, rebind_);
+            merged.push_back(std::move(segment.tokens[k]));
+        }
+    }
+
+    // 均匀地切回若干段，替换原来的段
+    std::vector<Segment> rebuilt;
+    size_t pieces = (merged.size() + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+    size_t next_index = segments_[begin_segment].first_index;
+    for (size_t p = 0; p < pieces; ++p) {
+        size_t begin = merged.size() * p / pieces;
+        size_t end = merged.size() * (p + 1) / pieces;
+        Segment segment;
+        segment.tokens.assign(std::make_move_iterator(merged.begin() + begin),
+                              std::make_move_iterator(merged.begin() + end));
+        segment.first_index = next_index;
+        segment.bound_source = source.data();
+        next_index += segment.tokens.size();
+        rebuilt.push_back(std::move(segment));
+    }
+    segments_.erase(segments_.begin() + begin_segment, segments_.begin() + end_segment + 1);
+    segments_.insert(segments_.begin() + begin_segment, std::make_move_iterator(rebuilt.begin()),
+                     std::make_move_iterator(rebuilt.end()));
+
+    // 之后的段只记录增量
+    for (size_t s = begin_segment + pieces; s < segments_.size(); ++s) {
+        Segment& segment = segments_[s];
+        segment.first_index = next_index;
+        segment.offset_delta += delta;
+        segment.line_delta += line_delta;
+        next_index += segment.tokens.size();
+    }
+
+    size_ = size_ - removed + fresh.size();
+    source_ = source;
+    last_segment_ = 0;
+}
+
+} // namespace dreamlang::lexer
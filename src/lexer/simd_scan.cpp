@@ -0,0 +1,366 @@
+#include "lexer/simd_scan.h"
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define DREAMLANG_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(DREAMLANG_SIMD_X86) && defined(__GNUC__)
+#define DREAMLANG_SIMD_AVX2 1
+#define DREAMLANG_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#endif
+
+namespace dreamlang::lexer::simd {
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// 标量实现（也用于处理向量实现剩余的尾部字节）
+// ---------------------------------------------------------------------------
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+const char* skipBlanksScalar(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+const char* findNewlineScalar(const char* p, const char* end) {
+    while (p < end && *p != '\n') {
+        ++p;
+    }
+    return p;
+}
+
+const char* findCommentEndScalar(const char* p, const char* end, size_t& newlines) {
+    while (p < end) {
+        if (*p == '*' && p + 1 < end && p[1] == '/') {
+            return p;
+        }
+        if (*p == '\n') {
+            ++newlines;
+        }
+        ++p;
+    }
+    return end;
+}
+
+inline bool isStringSpecial(char c) {
+    return c == '"' || c == '\\' || c == '\r';
+}
+
+const char* findStringSpecialScalar(const char* p, const char* end, size_t& newlines) {
+    while (p < end) {
+        if (isStringSpecial(*p)) {
+            return p;
+        }
+        if (*p == '\n') {
+            ++newlines;
+        }
+        ++p;
+    }
+    return end;
+}
+
+size_t countNewlinesScalar(const char* p, const char* end) {
+    size_t count = 0;
+    for (; p < end; ++p) {
+        count += (*p == '\n');
+    }
+    return count;
+}
+
+#ifdef DREAMLANG_SIMD_X86
+
+inline int countTrailingZeros(uint32_t mask) {
+#ifdef __GNUC__
+    return __builtin_ctz(mask);
+#else
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#endif
+}
+
+inline int popCount(uint32_t mask) {
+#ifdef __GNUC__
+    return __builtin_popcount(mask);
+#else
+    return static_cast<int>(__popcnt(mask));
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// SSE2 实现，每次处理 16 字节
+// ---------------------------------------------------------------------------
+
+inline uint32_t blankMask16(__m128i chunk) {
+    __m128i blanks = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+            _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')));
+    return static_cast<uint32_t>(_mm_movemask_epi8(blanks));
+}
+
+const char* skipBlanksSse2(const char* p, const char* end) {
+    while (end - p >= 16) {
+        uint32_t non_blank = ~blankMask16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) & 0xFFFFu;
+        if (non_blank != 0) {
+            return p + countTrailingZeros(non_blank);
+        }
+        p += 16;
+    }
+    return skipBlanksScalar(p, end);
+}
+
+const char* findNewlineSse2(const char* p, const char* end) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+        if (mask != 0) {
+            return p + countTrailingZeros(mask);
+        }
+        p += 16;
+    }
+    return findNewlineScalar(p, end);
+}
+
+const char* findCommentEndSse2(const char* p, const char* end, size_t& newlines) {
+    const __m128i star = _mm_set1_epi8('*');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i newline = _mm_set1_epi8('\n');
+    // 同时比较 p 和 p + 1 处的 16 字节，需要 17 字节可读
+    while (end - p >= 17) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+        auto terminator = static_cast<uint32_t>(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(chunk, star), _mm_cmpeq_epi8(next, slash))));
+        auto lines = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+        if (terminator != 0) {
+            int index = countTrailingZeros(terminator);
+            newlines += popCount(lines & ((1u << index) - 1));
+            return p + index;
+        }
+        newlines += popCount(lines);
+        p += 16;
+    }
+    return findCommentEndScalar(p, end, newlines);
+}
+
+const char* findStringSpecialSse2(const char* p, const char* end, size_t& newlines) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        auto special = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                _mm_cmpeq_epi8(chunk, carriage_return))));
+        auto lines = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+        if (special != 0) {
+            int index = countTrailingZeros(special);
+            newlines += popCount(lines & ((1u << index) - 1));
+            return p + index;
+        }
+        newlines += popCount(lines);
+        p += 16;
+    }
+    return findStringSpecialScalar(p, end, newlines);
+}
+
+size_t countNewlinesSse2(const char* p, const char* end) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t count = 0;
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        count += popCount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline))));
+        p += 16;
+    }
+    return count + countNewlinesScalar(p, end);
+}
+
+#endif // DREAMLANG_SIMD_X86
+
+#ifdef DREAMLANG_SIMD_AVX2
+
+// ---------------------------------------------------------------------------
+// AVX2 实现，每次处理 32 字节
+// ---------------------------------------------------------------------------
+
+DREAMLANG_TARGET_AVX2
+const char* skipBlanksAvx2(const char* p, const char* end) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i carriage_return = _mm256_set1_epi8('\r');
+    while (end - p >= 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i blanks = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+                _mm256_cmpeq_epi8(chunk, carriage_return));
+        uint32_t non_blank = ~static_cast<uint32_t>(_mm256_movemask_epi8(blanks));
+        if (non_blank != 0) {
+            return p + __builtin_ctz(non_blank);
+        }
+        p += 32;
+    }
+    return skipBlanksSse2(p, end);
+}
+
+DREAMLANG_TARGET_AVX2
+const char* findNewlineAvx2(const char* p, const char* end) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    while (end - p >= 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    return findNewlineSse2(p, end);
+}
+
+DREAMLANG_TARGET_AVX2
+const char* findCommentEndAvx2(const char* p, const char* end, size_t& newlines) {
+    const __m256i star = _mm256_set1_epi8('*');
+    const __m256i slash = _mm256_set1_epi8('/');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    while (end - p >= 33) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+        auto terminator = static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(chunk, star), _mm256_cmpeq_epi8(next, slash))));
+        auto lines = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+        if (terminator != 0) {
+            int index = __builtin_ctz(terminator);
+            uint32_t below = index == 0 ? 0u : (lines & (0xFFFFFFFFu >> (32 - index)));
+            newlines += __builtin_popcount(below);
+            return p + index;
+        }
+        newlines += __builtin_popcount(lines);
+        p += 32;
+    }
+    return findCommentEndSse2(p, end, newlines);
+}
+
+DREAMLANG_TARGET_AVX2
+const char* findStringSpecialAvx2(const char* p, const char* end, size_t& newlines) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i carriage_return = _mm256_set1_epi8('\r');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    while (end - p >= 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        auto special = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+                _mm256_cmpeq_epi8(chunk, carriage_return))));
+        auto lines = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+        if (special != 0) {
+            int index = __builtin_ctz(special);
+            uint32_t below = index == 0 ? 0u : (lines & (0xFFFFFFFFu >> (32 - index)));
+            newlines += __builtin_popcount(below);
+            return p + index;
+        }
+        newlines += __builtin_popcount(lines);
+        p += 32;
+    }
+    return findStringSpecialSse2(p, end, newlines);
+}
+
+DREAMLANG_TARGET_AVX2
+size_t countNewlinesAvx2(const char* p, const char* end) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t count = 0;
+    while (end - p >= 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        count += __builtin_popcount(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline))));
+        p += 32;
+    }
+    return count + countNewlinesSse2(p, end);
+}
+
+#endif // DREAMLANG_SIMD_AVX2
+
+/**
+ * 运行时选择的实现
+ */
+struct Dispatch {
+    const char* (*skip_blanks)(const char*, const char*);
+    const char* (*find_newline)(const char*, const char*);
+    const char* (*find_comment_end)(const char*, const char*, size_t&);
+    const char* (*find_string_special)(const char*, const char*, size_t&);
+    size_t (*count_newlines)(const char*, const char*);
+    const char* name;
+};
+
+Dispatch selectImplementation() {
+#ifdef DREAMLANG_SIMD_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+        return {skipBlanksAvx2, findNewlineAvx2, findCommentEndAvx2, findStringSpecialAvx2, countNewlinesAvx2,
+                "avx2"};
+    }
+#endif
+#ifdef DREAMLANG_SIMD_X86
+    return {skipBlanksSse2, findNewlineSse2, findCommentEndSse2, findStringSpecialSse2, countNewlinesSse2, "sse2"};
+#else
+    return {skipBlanksScalar, findNewlineScalar, findCommentEndScalar, findStringSpecialScalar, countNewlinesScalar,
+            "scalar"};
+#endif
+}
+
+const Dispatch& dispatch() {
+    static const Dispatch selected = selectImplementation();
+    return selected;
+}
+
+} // namespace
+
+const char* skipBlanks(const char* begin, const char* end) {
+    // 大多数空白只有一两个字符，先逐字节判断，较长的空白串再交给向量实现
+    const char* p = begin;
+    for (int i = 0; i < 4; ++i, ++p) {
+        if (p >= end || !isBlank(*p)) {
+            return p;
+        }
+    }
+    return dispatch().skip_blanks(p, end);
+}
+
+const char* findNewline(const char* begin, const char* end) {
+    return dispatch().find_newline(begin, end);
+}
+
+const char* findCommentEnd(const char* begin, const char* end, size_t& newlines) {
+    return dispatch().find_comment_end(begin, end, newlines);
+}
+
+const char* findStringSpecial(const char* begin, const char* end, size_t& newlines) {
+    // 短字符串在前几个字节内就能找到结束的引号，不必进入向量实现
+    const char* p = begin;
+    for (int i = 0; i < 8; ++i, ++p) {
+        if (p >= end || isStringSpecial(*p)) {
+            return p;
+        }
+        if (*p == '\n') {
+            ++newlines;
+        }
+    }
+    return dispatch().find_string_special(p, end, newlines);
+}
+
+size_t countNewlines(const char* begin, const char* end) {
+    return dispatch().count_newlines(begin, end);
+}
+
+const char* implementationName() {
+    return dispatch().name;
+}
+
+} // namespace dreamlang::lexer::simd
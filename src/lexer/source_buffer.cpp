@@ -0,0 +1,161 @@
+#include "lexer/source_buffer.h"
+#include <utility>
+
+#ifdef _WIN32
+#include <fstream>
+#include <sstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dreamlang::lexer {
+
+SourceBuffer::~SourceBuffer() {
+    close();
+}
+
+SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept {
+    *this = std::move(other);
+}
+
+SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+    if (this != &other) {
+        close();
+        bool uses_fallback = other.mapping_ == nullptr;
+        mapping_ = std::exchange(other.mapping_, nullptr);
+        mapping_size_ = std::exchange(other.mapping_size_, 0);
+        fallback_ = std::move(other.fallback_);
+        // 短字符串移动后地址会变化，视图需要重新指向
+        view_ = uses_fallback ? std::string_view(fallback_) : other.view_;
+        other.fallback_.clear();
+        other.view_ = std::string_view();
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool SourceBuffer::open(const std::string& path) {
+    close();
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    fallback_ = content.str();
+    view_ = fallback_;
+    return true;
+}
+
+void SourceBuffer::close() {
+    fallback_.clear();
+    view_ = std::string_view();
+}
+
+#else
+
+namespace {
+
+/**
+ * 读入整个文件描述符（用于管道、字符设备等无法映射的输入）
+ */
+bool readAll(int fd, std::string& content) {
+    char chunk[64 * 1024];
+    while (true) {
+        ssize_t count = ::read(fd, chunk, sizeof(chunk));
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (count == 0) {
+            return true;
+        }
+        content.append(chunk, static_cast<size_t>(count));
+    }
+}
+
+} // namespace
+
+bool SourceBuffer::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        int saved_errno = errno;
+        ::close(fd);
+        errno = saved_errno;
+        return false;
+    }
+
+    if (!S_ISREG(info.st_mode) || info.st_size == 0) {
+        bool success = readAll(fd, fallback_);
+        int saved_errno = errno;
+        ::close(fd);
+        errno = saved_errno;
+        view_ = fallback_;
+        return success;
+    }
+
+    const auto size = static_cast<size_t>(info.st_size);
+    const auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    // 至少多留一个字节作为 '\0' 哨兵：文件最后一页超出文件末尾的部分由内核填零，
+    // 文件大小恰好是页大小整数倍时，额外的匿名页提供这个字节
+    const size_t reserved = (size + 1 + page - 1) / page * page;
+
+    void* region = ::mmap(nullptr, reserved, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) {
+        int saved_errno = errno;
+        ::close(fd);
+        errno = saved_errno;
+        return false;
+    }
+
+    int flags = MAP_PRIVATE | MAP_FIXED;
+#ifdef MAP_POPULATE
+    // 一次性建立页表并触发预读，避免扫描时逐页缺页
+    flags |= MAP_POPULATE;
+#endif
+    void* mapped = ::mmap(region, size, PROT_READ, flags, fd, 0);
+    int saved_errno = errno;
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        ::munmap(region, reserved);
+        errno = saved_errno;
+        return false;
+    }
+
+#ifdef MADV_SEQUENTIAL
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+#endif
+
+    mapping_ = mapped;
+    mapping_size_ = reserved;
+    view_ = std::string_view(static_cast<const char*>(mapped), size);
+    return true;
+}
+
+void SourceBuffer::close() {
+    if (mapping_ != nullptr) {
+        ::munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+        mapping_size_ = 0;
+    }
+    fallback_.clear();
+    view_ = std::string_view();
+}
+
+#endif
+
+} // namespace dreamlang::lexer
@@ -0,0 +1,170 @@
+#include "lexer/stream_lexer.h"
+#include "lexer/simd_scan.h"
+#include <cerrno>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace dreamlang::lexer {
+
+namespace {
+
+// Token结束后需要看到的字节数：运算符看一个字符，数字的小数点还要再看一个
+constexpr size_t LOOKAHEAD = 2;
+
+} // namespace
+
+StreamLexer::StreamLexer(int fd, LexerOptions options, size_t block_size)
+    : fd_(fd), options_(options), block_size_(block_size == 0 ? DEFAULT_BLOCK_SIZE : block_size),
+      window_offset_(0), window_line_(1), window_column_(1), start_(0),
+      eof_(false), finished_(false), bytes_read_(0), next_(0) {
+}
+
+Token StreamLexer::nextToken() {
+    if (next_ >= pending_.size()) {
+        if (error_) {
+            DREAMLANG_THROW(LexicalException(*error_));
+        }
+        if (finished_) {
+            return pending_.back();
+        }
+        fill();
+        if (pending_.empty()) {
+            DREAMLANG_THROW(LexicalException(*error_));
+        }
+    }
+    return std::move(pending_[next_++]);
+}
+
+uint64_t StreamLexer::run(const Consumer& consumer) {
+    uint64_t count = 0;
+    while (true) {
+        Token token = nextToken();
+        ++count;
+        consumer(token);
+        if (token.getType() == TokenType::EOF_TOKEN) {
+            return count;
+        }
+    }
+}
+
+size_t StreamLexer::readBlock(size_t size) {
+    size_t old_size = window_.size();
+    window_.resize(old_size + size);
+    while (true) {
+#ifdef _WIN32
+        auto count = ::_read(fd_, &window_[old_size], static_cast<unsigned>(size));
+#else
+        ssize_t count = ::read(fd_, &window_[old_size], size);
+#endif
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            int error = errno;
+            window_.resize(old_size);
+            DREAMLANG_THROW(std::system_error(error, std::generic_category(), "read"));
+        }
+        window_.resize(old_size + static_cast<size_t>(count));
+        bytes_read_ += static_cast<uint64_t>(count);
+        return static_cast<size_t>(count);
+    }
+}
+
+void StreamLexer::compact() {
+    if (start_ == 0) {
+        return;
+    }
+    const char* base = window_.data();
+    size_t newlines = simd::countNewlines(base, base + start_);
+    if (newlines == 0) {
+        window_column_ += static_cast<int>(start_);
+    } else {
+        size_t last_newline = start_ - 1;
+        while (base[last_newline] != '\n') {
+            --last_newline;
+        }
+        window_line_ += static_cast<int>(newlines);
+        window_column_ = static_cast<int>(start_ - last_newline);
+    }
+    window_.erase(0, start_);
+    window_offset_ += start_;
+    start_ = 0;
+}
+
+Diagnostic StreamLexer::rebase(Diagnostic diagnostic) const {
+    if (!options_.track_positions) {
+        diagnostic.line += window_line_ - 1;
+    }
+    if (diagnostic.line == window_line_) {
+        diagnostic.column += window_column_ - 1;
+    }
+    return diagnostic;
+}
+
+void StreamLexer::fill() {
+    pending_.clear();
+    next_ = 0;
+
+    const bool recovering = !DREAMLANG_HAS_EXCEPTIONS || options_.recover_errors;
+    size_t read_size = block_size_;
+    while (pending_.empty() && !finished_ && !error_) {
+        compact();
+        if (!eof_ && readBlock(read_size) == 0) {
+            eof_ = true;
+        }
+
+        // 窗口内总是按恢复模式分析：截断的Token（如未结束的字符串）在窗口末尾成为 ILLEGAL Token，
+        // 与其他末尾的Token一样留到读入更多输入后重新分析
+        LexerOptions options = options_;
+        options.recover_errors = true;
+        options.max_errors = recovering ? (options_.max_errors == 0 ? 0 : options_.max_errors - diagnostics_.size()) : 1;
+        Lexical lexer = Lexical::borrowed(window_, options);
+        lexer.base_offset_ = window_offset_;
+        lexer.seek(0, window_line_);
+
+        size_t resume = 0;
+        while (true) {
+            size_t reported = lexer.diagnostics_.size();
+            Token token = lexer.nextToken();
+            bool at_end = token.getType() == TokenType::EOF_TOKEN;
+            if (!eof_ && at_end && !lexer.stopped_) {
+                // 窗口末尾可能是未结束的单行注释，从上一个Token之后重新分析
+                break;
+            }
+            if (!eof_ && !at_end && lexer.index_ + LOOKAHEAD > window_.size()) {
+                // 这个Token可能因为后面的输入而改变，从它的起点（之前的空白和注释都已完整）重新分析
+                resume = lexer.token_start_;
+                break;
+            }
+            if (lexer.diagnostics_.size() != reported) {
+                if (!recovering) {
+                    // 先交出出错位置之前的Token，再抛出错误
+                    error_ = rebase(lexer.diagnostics_[reported]);
+                    break;
+                }
+                for (size_t i = reported; i < lexer.diagnostics_.size(); ++i) {
+                    diagnostics_.push_back(rebase(lexer.diagnostics_[i]));
+                }
+            }
+            pending_.push_back(std::move(token));
+            resume = lexer.index_;
+            if (at_end) {
+                finished_ = true;
+                break;
+            }
+        }
+        start_ = resume;
+
+        // 没有任何进展（例如很长的字符串或注释）时加倍读取量，避免反复重新分析同一段输入
+        if (pending_.empty() && resume == 0) {
+            read_size *= 2;
+        }
+    }
+}
+
+} // namespace dreamlang::lexer
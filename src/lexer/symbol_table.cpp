@@ -0,0 +1,81 @@
+#include "lexer/symbol_table.h"
+#include <cstring>
+#include <functional>
+
+namespace dreamlang::lexer {
+
+namespace {
+
+inline unsigned floorLog2(uint64_t value) {
+#ifdef __GNUC__
+    return 63 - static_cast<unsigned>(__builtin_clzll(value));
+#else
+    unsigned result = 0;
+    while (value >>= 1) {
+        ++result;
+    }
+    return result;
+#endif
+}
+
+} // namespace
+
+SymbolTable::SymbolTable() : next_id_(0) {
+    for (auto& segment : segments_) {
+        segment.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+SymbolTable::~SymbolTable() {
+    for (auto& segment : segments_) {
+        delete[] segment.load(std::memory_order_relaxed);
+    }
+}
+
+uint32_t SymbolTable::intern(std::string_view name) {
+    size_t hash = std::hash<std::string_view>{}(name);
+    // 高位选分片，低位留给分片内的哈希表
+    Shard& shard = shards_[hash >> (sizeof(size_t) * 8 - SHARD_BITS)];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.ids.find(name);
+    if (it != shard.ids.end()) {
+        return it->second;
+    }
+
+    char* storage = static_cast<char*>(shard.arena.allocate(name.size() + 1, alignof(char)));
+    std::memcpy(storage, name.data(), name.size());
+    storage[name.size()] = '\0';
+    std::string_view stored(storage, name.size());
+
+    uint32_t id = next_id_.fetch_add(1, std::memory_order_acq_rel);
+    // 先写入文本再发布 ID：其他线程只能通过同一分片的锁或调用者的同步拿到这个 ID
+    *slot(id, true) = stored;
+    shard.ids.emplace(stored, id);
+    return id;
+}
+
+std::string_view SymbolTable::text(uint32_t id) const {
+    return *slot(id, false);
+}
+
+std::string_view* SymbolTable::slot(uint32_t id, bool allocate) const {
+    // 第 k 段从 FIRST_SEGMENT_SIZE * (2^k - 1) 开始
+    uint64_t scaled = (static_cast<uint64_t>(id) >> FIRST_SEGMENT_BITS) + 1;
+    unsigned segment = floorLog2(scaled);
+    size_t index = id - FIRST_SEGMENT_SIZE * ((size_t{1} << segment) - 1);
+
+    std::string_view* entries = segments_[segment].load(std::memory_order_acquire);
+    if (entries == nullptr && allocate) {
+        auto* fresh = new std::string_view[FIRST_SEGMENT_SIZE << segment];
+        if (segments_[segment].compare_exchange_strong(entries, fresh, std::memory_order_acq_rel)) {
+            entries = fresh;
+        } else {
+            // 其他分片的线程已经分配了这一段
+            delete[] fresh;
+        }
+    }
+    return entries + index;
+}
+
+} // namespace dreamlang::lexer
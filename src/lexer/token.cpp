@@ -1,34 +1,113 @@
 #include "lexer/token.h"
-#include <sstream>
+#include "lexer/token_format.h"
+#include <algorithm>
 
 namespace dreamlang::lexer {
 
-Token::Token(TokenType type, const std::string& value, int line)
-    : type_(type), value_(value), line_(line) {
+// 大量Token按值保存在数组中，大小直接影响缓存命中和内存占用
+static_assert(sizeof(Token) <= 48, "Token grew beyond 48 bytes");
+
+Token::Token(TokenType type, std::string value, int line, size_t offset) : Token(type, line, offset) {
+    assignOwned(value);
+}
+
+Token::Token(TokenType type, int line, size_t offset) : type_(type), line_(line), offset_(offset) {
+}
+
+Token Token::borrowed(TokenType type, std::string_view value, int line, size_t offset) {
+    Token token(type, line, offset);
+    token.assignBorrowed(value);
+    return token;
+}
+
+Token::~Token() {
+    release();
 }
 
+void Token::release() {
+    if (storage_ == Storage::HEAP) {
+        delete[] value_.ref.data;
+    }
+    storage_ = Storage::BORROWED;
+}
+
+void Token::assignOwned(std::string_view value) {
+    // value 可能指向本Token当前的值，先拷贝再释放
+    if (value.size() <= INLINE_CAPACITY) {
+        char chars[INLINE_CAPACITY];
+        std::copy_n(value.data(), value.size(), chars);
+        release();
+        std::copy_n(chars, value.size(), value_.chars);
+        inline_size_ = static_cast<uint8_t>(value.size());
+        storage_ = Storage::INLINE;
+    } else {
+        char* data = new char[value.size()];
+        std::copy_n(value.data(), value.size(), data);
+        release();
+        value_.ref = {data, value.size()};
+        storage_ = Storage::HEAP;
+    }
+}
+
+void Token::assignBorrowed(std::string_view value) {
+    release();
+    value_.ref = {value.data(), value.size()};
+}
+
+void Token::shift(std::ptrdiff_t delta, int line_delta, std::string_view source, bool rebind) {
+    offset_ = static_cast<size_t>(static_cast<std::ptrdiff_t>(offset_) + delta);
+    line_ += line_delta;
+    if (rebind && storage_ == Storage::BORROWED) {
+        size_t lead = (type_ == TokenType::STRING || type_ == TokenType::CHAR) ? 1 : 0;
+        std::string_view value = source.substr(offset_ + lead, value_.ref.size);
+        value_.ref = {value.data(), value.size()};
+    }
+}
+
+// 只有堆上的值需要深拷贝；移动时转移所有权，被移动的Token变为空值
 Token::Token(const Token& other)
-    : type_(other.type_), value_(other.value_), line_(other.line_) {
+    : type_(other.type_), symbol_(other.symbol_), value_(other.value_), line_(other.line_),
+      storage_(other.storage_), number_form_(other.number_form_), inline_size_(other.inline_size_),
+      offset_(other.offset_), number_(other.number_) {
+    if (storage_ == Storage::HEAP) {
+        storage_ = Storage::BORROWED;
+        assignOwned(other.getValue());
+    }
 }
 
 Token::Token(Token&& other) noexcept
-    : type_(other.type_), value_(std::move(other.value_)), line_(other.line_) {
+    : type_(other.type_), symbol_(other.symbol_), value_(other.value_), line_(other.line_),
+      storage_(other.storage_), number_form_(other.number_form_), inline_size_(other.inline_size_),
+      offset_(other.offset_), number_(other.number_) {
+    if (other.storage_ == Storage::HEAP) {
+        other.storage_ = Storage::BORROWED;
+        other.value_.ref = {nullptr, 0};
+    }
 }
 
 Token& Token::operator=(const Token& other) {
     if (this != &other) {
-        type_ = other.type_;
-        value_ = other.value_;
-        line_ = other.line_;
+        *this = Token(other);
     }
     return *this;
 }
 
 Token& Token::operator=(Token&& other) noexcept {
     if (this != &other) {
+        release();
         type_ = other.type_;
-        value_ = std::move(other.value_);
+        symbol_ = other.symbol_;
+        value_ = other.value_;
         line_ = other.line_;
+        storage_ = other.storage_;
+        number_form_ = other.number_form_;
+        inline_size_ = other.inline_size_;
+        offset_ = other.offset_;
+        number_ = other.number_;
+        if (other.storage_ == Storage::HEAP) {
+            other.storage_ = Storage::BORROWED;
+            other.value_.ref = {nullptr, 0};
+        }
     }
     return *this;
 }
@@ -72,18 +151,24 @@ bool Token::isLiteral() const {
 }
 
 std::string Token::toString() const {
-    std::ostringstream oss;
-    oss << "Token{type=" << tokenTypeToString(type_) 
-        << ", value=\"" << value_ << "\""
-        << ", line=" << line_ 
-        <<  "}";
-    return oss.str();
+    // 与 -t 的列表使用同一个格式化函数；短Token直接放进小缓冲区，只在析构时追加一次
+    std::string text;
+    {
+        OutputBuffer out(text, 64);
+        formatToken(*this, out);
+    }
+    return text;
 }
 
 bool Token::operator==(const Token& other) const {
-    return type_ == other.type_ && 
-           value_ == other.value_ && 
-           line_ == other.line_ ;
+    if (type_ != other.type_ || line_ != other.line_) {
+        return false;
+    }
+    // 两个标识符都已驻留时比较 ID，不必比较名字
+    if (hasSymbol() && other.hasSymbol()) {
+        return symbol_ == other.symbol_;
+    }
+    return getValue() == other.getValue();
 }
 
 bool Token::operator!=(const Token& other) const {
@@ -0,0 +1,19 @@
+#include "lexer/token_arena.h"
+
+namespace dreamlang::lexer {
+
+TokenArena::TokenArena(size_t initial_size)
+    : resource_(initial_size == 0 ? 1 : initial_size), tokens_(&resource_) {
+}
+
+TokenArena::~TokenArena() {
+    clear();
+}
+
+void TokenArena::clear() {
+    // Token的析构不释放任何内存（它们都不持有值），只需先于 arena 完成
+    std::pmr::vector<Token>(&resource_).swap(tokens_);
+    resource_.release();
+}
+
+} // namespace dreamlang::lexer
@@ -0,0 +1,79 @@
+#include "lexer/token_buffer.h"
+#include <algorithm>
+
+namespace dreamlang::lexer {
+
+std::string_view TokenBuffer::value(size_t index) const {
+    TokenType token_type = type(index);
+    if ((token_type == TokenType::STRING || token_type == TokenType::CHAR) && !decoded_index_.empty()) {
+        auto it = std::lower_bound(decoded_index_.begin(), decoded_index_.end(), index,
+                                   [](const std::pair<uint32_t, uint32_t>& entry, size_t i) {
+                                       return entry.first < i;
+                                   });
+        if (it != decoded_index_.end() && it->first == index) {
+            size_t begin = it->second;
+            size_t end = (it + 1 != decoded_index_.end()) ? (it + 1)->second : decoded_pool_.size();
+            return std::string_view(decoded_pool_).substr(begin, end - begin);
+        }
+    }
+    return source_.substr(offsets_[index], lengths_[index]);
+}
+
+int TokenBuffer::line(size_t index) const {
+    // 找到最后一个起始下标不大于 index 的行号游程
+    auto it = std::upper_bound(line_runs_.begin(), line_runs_.end(), index,
+                               [](size_t i, const std::pair<uint32_t, uint32_t>& run) {
+                                   return i < run.first;
+                               });
+    if (it == line_runs_.begin()) {
+        return 1;
+    }
+    return static_cast<int>((it - 1)->second);
+}
+
+void TokenBuffer::reserve(size_t count) {
+    types_.reserve(count);
+    offsets_.reserve(count);
+    lengths_.reserve(count);
+}
+
+void TokenBuffer::clear() {
+    types_.clear();
+    offsets_.clear();
+    lengths_.clear();
+    line_runs_.clear();
+    decoded_index_.clear();
+    decoded_pool_.clear();
+}
+
+size_t TokenBuffer::memoryUsage() const {
+    return types_.capacity() * sizeof(uint8_t) +
+           offsets_.capacity() * sizeof(uint32_t) +
+           lengths_.capacity() * sizeof(uint32_t) +
+           line_runs_.capacity() * sizeof(std::pair<uint32_t, uint32_t>) +
+           decoded_index_.capacity() * sizeof(std::pair<uint32_t, uint32_t>) +
+           decoded_pool_.capacity();
+}
+
+void TokenBuffer::attach(std::string_view source) {
+    clear();
+    source_ = source;
+}
+
+void TokenBuffer::append(TokenType type, size_t offset, size_t length, int line) {
+    auto index = static_cast<uint32_t>(types_.size());
+    if (line_runs_.empty() || line_runs_.back().second != static_cast<uint32_t>(line)) {
+        line_runs_.emplace_back(index, static_cast<uint32_t>(line));
+    }
+    types_.push_back(static_cast<uint8_t>(type));
+    offsets_.push_back(static_cast<uint32_t>(offset));
+    lengths_.push_back(static_cast<uint32_t>(length));
+}
+
+void TokenBuffer::appendDecoded(TokenType type, size_t offset, size_t length, std::string_view decoded, int line) {
+    decoded_index_.emplace_back(static_cast<uint32_t>(types_.size()), static_cast<uint32_t>(decoded_pool_.size()));
+    decoded_pool_.append(decoded);
+    append(type, offset, length, line);
+}
+
+} // namespace dreamlang::lexer
@@ -0,0 +1,172 @@
+#include "lexer/token_cache.h"
+#include "lexer/content_hash.h"
+#include <algorithm>
+#include <cstring>
+
+namespace dreamlang::lexer {
+
+namespace {
+
+constexpr char CACHE_MAGIC[8] = {'D', 'L', 'T', 'O', 'K', 'E', 'N', 'S'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+} // namespace
+
+uint32_t tokenCacheOptions(const LexerOptions& options) {
+    uint32_t bits = 0;
+    if (options.track_positions) {
+        bits |= TOKEN_CACHE_TRACK_POSITIONS;
+    }
+    if (options.recover_errors) {
+        bits |= TOKEN_CACHE_RECOVER_ERRORS;
+    }
+    return bits;
+}
+
+std::string encodeTokenCache(const std::vector<Token>& tokens, std::string_view source, const LexerOptions& options) {
+    std::vector<TokenRecord> records(tokens.size());
+    std::string pool;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const Token& token = tokens[i];
+        TokenRecord& record = records[i];
+        record.offset = token.getOffset();
+        record.line = static_cast<uint32_t>(token.getLine());
+        record.type = static_cast<uint8_t>(token.getType());
+        record.number_form = static_cast<uint8_t>(token.getNumberForm());
+        if (token.getNumberForm() == NumberForm::INTEGER) {
+            record.number.integer = token.getInteger();
+        } else if (token.getNumberForm() == NumberForm::FLOAT) {
+            record.number.real = token.getFloat();
+        }
+
+        std::string_view value = token.getValue();
+        record.value_length = static_cast<uint32_t>(value.size());
+        if (value.empty()) {
+            continue;
+        }
+        // 值与源码中Token起点（字面量为开头的引号之后）的文本相同时只记录位置，与Token是否持有值无关
+        size_t offset = token.getOffset();
+        if (source.compare(std::min(offset, source.size()), value.size(), value) == 0) {
+            record.value_offset = 0;
+        } else if (offset < source.size() && source.compare(offset + 1, value.size(), value) == 0) {
+            record.value_offset = 1;
+        } else {
+            record.flags |= TOKEN_RECORD_POOLED;
+            record.value_offset = static_cast<uint32_t>(pool.size());
+            pool.append(value);
+        }
+    }
+
+    TokenCacheHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = TOKEN_CACHE_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.source_hash = contentHash(source);
+    header.source_size = source.size();
+    header.token_count = tokens.size();
+    header.pool_offset = sizeof(TokenCacheHeader) + records.size() * sizeof(TokenRecord);
+    header.pool_size = pool.size();
+    header.lexer_version = LEXER_OUTPUT_VERSION;
+    header.lexer_options = tokenCacheOptions(options);
+
+    std::string content;
+    content.reserve(header.pool_offset + pool.size());
+    content.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    content.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(TokenRecord));
+    content.append(pool);
+    return content;
+}
+
+bool TokenCacheReader::open(const std::string& path) {
+    close();
+    if (!file_.open(path)) {
+        return false;
+    }
+
+    std::string_view data = file_.view();
+    if (data.size() < sizeof(TokenCacheHeader)) {
+        close();
+        return false;
+    }
+    // 映射的起点按页对齐，读入的缓冲区来自堆分配，都满足记录的对齐要求
+    const auto* header = reinterpret_cast<const TokenCacheHeader*>(data.data());
+    if (std::memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header->version != TOKEN_CACHE_VERSION || header->byte_order != BYTE_ORDER_MARK ||
+        header->lexer_version != LEXER_OUTPUT_VERSION) {
+        close();
+        return false;
+    }
+
+    // 记录数组和字符串池都必须完整地位于文件中
+    size_t available = data.size() - sizeof(TokenCacheHeader);
+    if (header->token_count > available / sizeof(TokenRecord) ||
+        header->pool_offset < sizeof(TokenCacheHeader) + header->token_count * sizeof(TokenRecord) ||
+        header->pool_offset > data.size() || header->pool_size > data.size() - header->pool_offset) {
+        close();
+        return false;
+    }
+
+    // token() 直接把类型和数字形式转换为枚举，无效的值在这里拒绝
+    const auto* records = reinterpret_cast<const TokenRecord*>(data.data() + sizeof(TokenCacheHeader));
+    for (size_t i = 0; i < header->token_count; ++i) {
+        if (records[i].type >= TOKEN_TYPE_COUNT || records[i].number_form > static_cast<uint8_t>(NumberForm::FLOAT)) {
+            close();
+            return false;
+        }
+    }
+
+    header_ = header;
+    records_ = records;
+    pool_ = data.substr(header->pool_offset, header->pool_size);
+    return true;
+}
+
+void TokenCacheReader::close() {
+    file_.close();
+    header_ = nullptr;
+    records_ = nullptr;
+    pool_ = {};
+}
+
+bool TokenCacheReader::matches(std::string_view source, const LexerOptions& options) const {
+    return header_ != nullptr && header_->lexer_options == tokenCacheOptions(options) &&
+           header_->source_size == source.size() && header_->source_hash == contentHash(source);
+}
+
+std::string_view TokenCacheReader::value(const TokenRecord& record, std::string_view source) const {
+    if (record.flags & TOKEN_RECORD_POOLED) {
+        if (record.value_offset > pool_.size() || record.value_length > pool_.size() - record.value_offset) {
+            return {};
+        }
+        return pool_.substr(record.value_offset, record.value_length);
+    }
+    uint64_t begin = record.offset + record.value_offset;
+    if (begin > source.size() || record.value_length > source.size() - begin) {
+        return {};
+    }
+    return source.substr(begin, record.value_length);
+}
+
+Token TokenCacheReader::token(size_t index, std::string_view source) const {
+    const TokenRecord& record = records_[index];
+    Token token = Token::borrowed(static_cast<TokenType>(record.type), value(record, source),
+                                  static_cast<int>(record.line), record.offset);
+    token.number_form_ = static_cast<NumberForm>(record.number_form);
+    if (token.number_form_ == NumberForm::INTEGER) {
+        token.number_.integer = record.number.integer;
+    } else if (token.number_form_ == NumberForm::FLOAT) {
+        token.number_.real = record.number.real;
+    }
+    return token;
+}
+
+std::vector<Token> TokenCacheReader::tokens(std::string_view source) const {
+    std::vector<Token> result;
+    result.reserve(size());
+    for (size_t i = 0; i < size(); ++i) {
+        result.push_back(token(i, source));
+    }
+    return result;
+}
+
+} // namespace dreamlang::lexer
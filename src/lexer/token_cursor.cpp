@@ -0,0 +1,88 @@
+#include "lexer/token_cursor.h"
+#include <algorithm>
+#include <utility>
+
+namespace dreamlang::lexer {
+
+namespace {
+
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+TokenCursor::TokenCursor(Lexical& lexer, size_t capacity)
+    : lexer_(lexer), ring_(roundUpToPowerOfTwo(std::max<size_t>(capacity, 2)),
+                           Token(TokenType::EOF_TOKEN, std::string(), 0)) {
+}
+
+const Token& TokenCursor::peek(size_t k) {
+    while (position_ + k >= base_ + count_) {
+        if (at_eof_) {
+            // EOF 之后的位置都看作EOF Token
+            return slot(base_ + count_ - 1);
+        }
+        fill();
+    }
+    return slot(position_ + k);
+}
+
+const Token& TokenCursor::next() {
+    const Token& token = peek(0);
+    // 停在EOF Token上，之后一直返回它
+    if (!(at_eof_ && position_ + 1 == base_ + count_)) {
+        ++position_;
+    }
+    return token;
+}
+
+TokenCursor::Mark TokenCursor::mark() {
+    marks_.push_back(position_);
+    return position_;
+}
+
+void TokenCursor::rewind(Mark mark) {
+    position_ = mark;
+}
+
+void TokenCursor::release(Mark mark) {
+    // 标记通常按嵌套顺序释放，从末尾查找
+    auto it = std::find(marks_.rbegin(), marks_.rend(), mark);
+    if (it != marks_.rend()) {
+        marks_.erase(std::next(it).base());
+    }
+}
+
+void TokenCursor::fill() {
+    Token token = lexer_.nextToken();
+
+    if (count_ == ring_.size()) {
+        // 当前位置和最早的标记之前的Token都不会再被访问
+        size_t keep_from = position_;
+        for (Mark mark : marks_) {
+            keep_from = std::min(keep_from, mark);
+        }
+        if (keep_from > base_) {
+            count_ -= keep_from - base_;
+            base_ = keep_from;
+        } else {
+            // 缓冲区中的Token都还需要保留，容量加倍后按序号重新放置
+            std::vector<Token> larger(ring_.size() * 2, Token(TokenType::EOF_TOKEN, std::string(), 0));
+            for (size_t index = base_; index < base_ + count_; ++index) {
+                larger[index & (larger.size() - 1)] = std::move(slot(index));
+            }
+            ring_.swap(larger);
+        }
+    }
+
+    at_eof_ = token.getType() == TokenType::EOF_TOKEN;
+    slot(base_ + count_) = std::move(token);
+    ++count_;
+}
+
+} // namespace dreamlang::lexer
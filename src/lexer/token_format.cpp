@@ -0,0 +1,96 @@
+#include "lexer/token_format.h"
+#include <charconv>
+#include <cstring>
+
+namespace dreamlang::lexer {
+
+namespace {
+
+// ALIGNED 布局中行号和类型列的宽度，类型列取最长的类型名
+constexpr size_t LINE_WIDTH = 6;
+constexpr size_t TYPE_WIDTH = 14;
+
+const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+/**
+ * 写入转义后的值：反斜杠和常见空白写成 \\、\t、\n、\r，其他控制字符写成 \xHH，其余字节原样写入
+ * 不需要转义的连续字节整段写入
+ */
+void writeEscaped(OutputBuffer& out, std::string_view text) {
+    size_t start = 0;
+    for (size_t index = 0; index < text.size(); ++index) {
+        unsigned char c = static_cast<unsigned char>(text[index]);
+        if (c >= 0x20 && c != '\\' && c != 0x7F) {
+            continue;
+        }
+        out.write(text.substr(start, index - start));
+        switch (c) {
+            case '\\': out.write("\\\\"); break;
+            case '\t': out.write("\\t"); break;
+            case '\n': out.write("\\n"); break;
+            case '\r': out.write("\\r"); break;
+            default: {
+                char escape[] = {'\\', 'x', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0xF]};
+                out.write(std::string_view(escape, sizeof(escape)));
+                break;
+            }
+        }
+        start = index + 1;
+    }
+    out.write(text.substr(start));
+}
+
+} // namespace
+
+void formatToken(const Token& token, OutputBuffer& out, TokenLayout layout) {
+    const char* type = tokenTypeToString(token.getType());
+    switch (layout) {
+        case TokenLayout::DEFAULT:
+            out.write("Token{type=");
+            out.write(type);
+            out.write(", value=\"");
+            out.write(token.getValue());
+            out.write("\", line=");
+            out.writeInteger(token.getLine());
+            out.put('}');
+            break;
+        case TokenLayout::ALIGNED: {
+            // 行号右对齐，类型左对齐，超出宽度时不截断
+            char digits[24];
+            auto result = std::to_chars(digits, digits + sizeof(digits), token.getLine());
+            size_t length = static_cast<size_t>(result.ptr - digits);
+            out.fill(' ', length < LINE_WIDTH ? LINE_WIDTH - length : 0);
+            out.write(std::string_view(digits, length));
+            out.write("  ");
+            size_t type_length = std::strlen(type);
+            out.write(std::string_view(type, type_length));
+            if (!token.getValue().empty()) {
+                out.fill(' ', (type_length < TYPE_WIDTH ? TYPE_WIDTH - type_length : 0) + 2);
+                writeEscaped(out, token.getValue());
+            }
+            break;
+        }
+        case TokenLayout::TSV:
+            out.writeInteger(token.getLine());
+            out.put('\t');
+            out.write(type);
+            out.put('\t');
+            writeEscaped(out, token.getValue());
+            break;
+    }
+}
+
+void formatTokenHeader(OutputBuffer& out, TokenLayout layout) {
+    switch (layout) {
+        case TokenLayout::DEFAULT:
+            break;
+        case TokenLayout::ALIGNED:
+            out.write("  LINE  TYPE            VALUE\n");
+            break;
+        case TokenLayout::TSV:
+            out.write("line\ttype\tvalue\n");
+            break;
+    }
+}
+
+} // namespace dreamlang::lexer
@@ -1,39 +1,388 @@
 #include "lexer/token_serialize.h"
 
-#include <nlohmann/json.hpp>
-#include <toml++/toml.hpp>
 #include <sstream>
 
 namespace dreamlang::lexer {
-    std::string serialize(const std::vector<Token>& tokens, const std::string& format) {
-        if (format == "json") {
-            nlohmann::json j;
+    namespace {
+        /*
+         * 获取 text[index] 开始的合法 UTF-8 序列的长度
+         * @return 序列长度；过长编码、代理项、超出 U+10FFFF 或不完整时为 0
+         */
+        size_t utf8SequenceLength(std::string_view text, size_t index) {
+            auto byte = [&](size_t offset) { return static_cast<unsigned char>(text[index + offset]); };
+            unsigned char lead = byte(0);
+            size_t length;
+            unsigned char low = 0x80;
+            unsigned char high = 0xBF;
+            if (lead >= 0xC2 && lead <= 0xDF) {
+                length = 2;
+            } else if (lead >= 0xE0 && lead <= 0xEF) {
+                length = 3;
+                if (lead == 0xE0) {
+                    low = 0xA0;
+                } else if (lead == 0xED) {
+                    high = 0x9F;
+                }
+            } else if (lead >= 0xF0 && lead <= 0xF4) {
+                length = 4;
+                if (lead == 0xF0) {
+                    low = 0x90;
+                } else if (lead == 0xF4) {
+                    high = 0x8F;
+                }
+            } else {
+                return 0;
+            }
+            if (text.size() - index < length || byte(1) < low || byte(1) > high) {
+                return 0;
+            }
+            for (size_t offset = 2; offset < length; ++offset) {
+                if ((byte(offset) & 0xC0) != 0x80) {
+                    return 0;
+                }
+            }
+            return length;
+        }
+
+        const char HEX_DIGITS[] = "0123456789abcdef";
+
+        /*
+         * 写入 \u00XX 形式的转义
+         */
+        void writeUnicodeEscape(OutputBuffer& out, unsigned char c) {
+            char escape[] = {'\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0xF]};
+            out.write(std::string_view(escape, sizeof(escape)));
+        }
+
+        /*
+         * 写入带引号的字符串，JSON 和 TOML 的基本字符串使用相同的转义规则
+         * 无需转义的连续字节整段写入
+         */
+        void writeQuoted(OutputBuffer& out, std::string_view text) {
+            out.put('"');
+            size_t start = 0;
+            size_t index = 0;
+            while (index < text.size()) {
+                unsigned char c = static_cast<unsigned char>(text[index]);
+                if (c >= 0x20 && c != '"' && c != '\\' && c != 0x7F && c < 0x80) {
+                    ++index;
+                    continue;
+                }
+                size_t length = c >= 0x80 ? utf8SequenceLength(text, index) : 0;
+                if (length != 0) {
+                    index += length;
+                    continue;
+                }
+
+                out.write(text.substr(start, index - start));
+                switch (c) {
+                    case '"': out.write("\\\""); break;
+                    case '\\': out.write("\\\\"); break;
+                    case '\b': out.write("\\b"); break;
+                    case '\f': out.write("\\f"); break;
+                    case '\n': out.write("\\n"); break;
+                    case '\r': out.write("\\r"); break;
+                    case '\t': out.write("\\t"); break;
+                    default:
+                        if (c >= 0x80) {
+                            // 非法的 UTF-8 字节无法表示，替换为 U+FFFD
+                            out.write("\\ufffd");
+                        } else {
+                            writeUnicodeEscape(out, c);
+                        }
+                        break;
+                }
+                start = ++index;
+            }
+            out.write(text.substr(start));
+            out.put('"');
+        }
+
+        /*
+         * 写入 TOML 字符串：尽量使用不需要转义的字面量字符串，含换行时使用多行字面量字符串，
+         * 含单引号、其他控制字符或非法 UTF-8 时退回带转义的基本字符串
+         * @param allow_multi_line 是否允许多行字符串（内联表中不允许）
+         */
+        void writeTomlString(OutputBuffer& out, std::string_view text, bool allow_multi_line) {
+            bool has_line_break = false;
+            bool literal = true;
+            for (size_t index = 0; index < text.size() && literal;) {
+                unsigned char c = static_cast<unsigned char>(text[index]);
+                if (c >= 0x80) {
+                    size_t length = utf8SequenceLength(text, index);
+                    literal = length != 0;
+                    index += length;
+                    continue;
+                }
+                if (c == '\n') {
+                    has_line_break = true;
+                } else if (c == '\'' || c == 0x7F || (c < 0x20 && c != '\t')) {
+                    literal = false;
+                }
+                ++index;
+            }
+
+            if (!literal || (has_line_break && !allow_multi_line)) {
+                writeQuoted(out, text);
+            } else if (has_line_break) {
+                // 紧跟开头定界符的换行会被 TOML 解析器去掉，补一个换行保证值不变
+                out.write("'''\n");
+                out.write(text);
+                out.write("'''");
+            } else {
+                out.put('\'');
+                out.write(text);
+                out.put('\'');
+            }
+        }
+
+        /*
+         * 检查文本是否是合法的 UTF-8
+         */
+        bool isValidUtf8(std::string_view text) {
+            for (size_t index = 0; index < text.size();) {
+                if (static_cast<unsigned char>(text[index]) < 0x80) {
+                    ++index;
+                    continue;
+                }
+                size_t length = utf8SequenceLength(text, index);
+                if (length == 0) {
+                    return false;
+                }
+                index += length;
+            }
+            return true;
+        }
+
+        /*
+         * 以大端序写入 bytes 字节的无符号整数
+         */
+        void writeBigEndian(OutputBuffer& out, uint64_t value, int bytes) {
+            for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+                out.put(static_cast<char>((value >> shift) & 0xFF));
+            }
+        }
+
+        /*
+         * MessagePack 编码：按值的大小选择最短的表示
+         */
+        class MsgpackEncoder {
+        public:
+            explicit MsgpackEncoder(OutputBuffer& out) : out_(out) {}
+
+            void writeUnsigned(uint64_t value) {
+                if (value < 0x80) {
+                    out_.put(static_cast<char>(value));
+                } else {
+                    writeHead(value, 0xCC, 0xCD, 0xCE, 0xCF);
+                }
+            }
+
+            void writeArrayHeader(uint64_t size) {
+                if (size < 16) {
+                    out_.put(static_cast<char>(0x90 | size));
+                } else {
+                    writeHead(size, 0, 0xDC, 0xDD, 0);
+                }
+            }
+
+            void writeMapHeader(uint64_t size) {
+                if (size < 16) {
+                    out_.put(static_cast<char>(0x80 | size));
+                } else {
+                    writeHead(size, 0, 0xDE, 0xDF, 0);
+                }
+            }
+
+            void writeString(std::string_view text) {
+                if (!isValidUtf8(text)) {
+                    writeHead(text.size(), 0xC4, 0xC5, 0xC6, 0);
+                } else if (text.size() < 32) {
+                    out_.put(static_cast<char>(0xA0 | text.size()));
+                } else {
+                    writeHead(text.size(), 0xD9, 0xDA, 0xDB, 0);
+                }
+                out_.write(text);
+            }
+
+        private:
+            /*
+             * 写入类型字节和 1、2、4 或 8 字节的长度（值），对应的类型字节为 0 表示该宽度不可用
+             * 集合和字符串的长度在 32 位以内，不会用到不可用的宽度
+             */
+            void writeHead(uint64_t value, unsigned char type8, unsigned char type16, unsigned char type32,
+                           unsigned char type64) {
+                if (value <= 0xFF && type8 != 0) {
+                    out_.put(static_cast<char>(type8));
+                    writeBigEndian(out_, value, 1);
+                } else if (value <= 0xFFFF) {
+                    out_.put(static_cast<char>(type16));
+                    writeBigEndian(out_, value, 2);
+                } else if (value <= 0xFFFFFFFF || type64 == 0) {
+                    out_.put(static_cast<char>(type32));
+                    writeBigEndian(out_, value, 4);
+                } else {
+                    out_.put(static_cast<char>(type64));
+                    writeBigEndian(out_, value, 8);
+                }
+            }
+
+            OutputBuffer& out_;
+        };
+
+        /*
+         * CBOR 编码：全部使用定长集合和最短的参数编码
+         */
+        class CborEncoder {
+        public:
+            explicit CborEncoder(OutputBuffer& out) : out_(out) {}
+
+            void writeUnsigned(uint64_t value) { writeHead(0, value); }
+
+            void writeArrayHeader(uint64_t size) { writeHead(4, size); }
+
+            void writeMapHeader(uint64_t size) { writeHead(5, size); }
+
+            void writeString(std::string_view text) {
+                // 文本字符串必须是合法 UTF-8，否则写为字节串
+                writeHead(isValidUtf8(text) ? 3 : 2, text.size());
+                out_.write(text);
+            }
+
+        private:
+            void writeHead(unsigned char major, uint64_t value) {
+                unsigned char type = static_cast<unsigned char>(major << 5);
+                if (value < 24) {
+                    out_.put(static_cast<char>(type | value));
+                } else if (value <= 0xFF) {
+                    out_.put(static_cast<char>(type | 24));
+                    writeBigEndian(out_, value, 1);
+                } else if (value <= 0xFFFF) {
+                    out_.put(static_cast<char>(type | 25));
+                    writeBigEndian(out_, value, 2);
+                } else if (value <= 0xFFFFFFFF) {
+                    out_.put(static_cast<char>(type | 26));
+                    writeBigEndian(out_, value, 4);
+                } else {
+                    out_.put(static_cast<char>(type | 27));
+                    writeBigEndian(out_, value, 8);
+                }
+            }
+
+            OutputBuffer& out_;
+        };
+
+        /*
+         * 按二进制格式的文档结构写入Token列表
+         * 键按名称排序写入，与 nlohmann 等库从对象编码的结果一致
+         */
+        template <typename Encoder>
+        void writeBinary(const std::vector<Token>& tokens, Encoder encoder) {
+            encoder.writeMapHeader(2);
+            encoder.writeString("tokens");
+            encoder.writeArrayHeader(tokens.size());
             for (const auto& token : tokens) {
-                j.push_back({
-                    {"type", tokenTypeToString(token.getType())},
-                    {"value", token.getValue()},
-                    {"line", token.getLine()}
-                });
+                encoder.writeArrayHeader(3);
+                encoder.writeUnsigned(static_cast<uint64_t>(token.getLine()));
+                encoder.writeUnsigned(static_cast<uint64_t>(token.getType()));
+                encoder.writeString(token.getValue());
             }
-            return j.dump(4);
-        } else if (format == "toml") {
-            toml::table tbl;
-            toml::array tokens_array;
 
+            encoder.writeString("types");
+            encoder.writeArrayHeader(TOKEN_TYPE_COUNT);
+            for (size_t type = 0; type < TOKEN_TYPE_COUNT; ++type) {
+                encoder.writeString(tokenTypeToString(static_cast<TokenType>(type)));
+            }
+        }
+    } // namespace
+
+    void writeJson(const std::vector<Token>& tokens, OutputBuffer& out, SerializeStyle style) {
+        bool pretty = style == SerializeStyle::PRETTY;
+        if (tokens.empty()) {
+            out.write("[]");
+            return;
+        }
+
+        // 字段按名称排序，与之前通过 JSON 文档输出的结果一致
+        out.put('[');
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            const Token& token = tokens[i];
+            if (i != 0) {
+                out.put(',');
+            }
+            out.write(pretty ? "\n    {\n        \"line\": " : "{\"line\":");
+            out.writeInteger(token.getLine());
+            out.write(pretty ? ",\n        \"type\": " : ",\"type\":");
+            writeQuoted(out, tokenTypeToString(token.getType()));
+            out.write(pretty ? ",\n        \"value\": " : ",\"value\":");
+            writeQuoted(out, token.getValue());
+            out.write(pretty ? "\n    }" : "}");
+        }
+        out.write(pretty ? "\n]" : "]");
+    }
+
+    void writeToml(const std::vector<Token>& tokens, OutputBuffer& out, SerializeStyle style) {
+        if (tokens.empty()) {
+            out.write("tokens = []");
+            return;
+        }
+
+        if (style == SerializeStyle::COMPACT) {
+            out.write("tokens = [\n");
             for (const auto& token : tokens) {
-                toml::table token_table;
-                token_table.insert("type", tokenTypeToString(token.getType()));
-                token_table.insert("value", token.getValue());
-                token_table.insert("line", token.getLine());
-                tokens_array.push_back(std::move(token_table));
+                out.write("{ line = ");
+                out.writeInteger(token.getLine());
+                out.write(", type = ");
+                writeTomlString(out, tokenTypeToString(token.getType()), false);
+                out.write(", value = ");
+                writeTomlString(out, token.getValue(), false);
+                out.write(" },\n");
             }
+            out.put(']');
+            return;
+        }
+
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            const Token& token = tokens[i];
+            out.write(i == 0 ? "[[tokens]]\nline = " : "\n\n[[tokens]]\nline = ");
+            out.writeInteger(token.getLine());
+            out.write("\ntype = ");
+            writeTomlString(out, tokenTypeToString(token.getType()), true);
+            out.write("\nvalue = ");
+            writeTomlString(out, token.getValue(), true);
+        }
+    }
 
-            tbl.insert("tokens", std::move(tokens_array));
+    void writeMsgpack(const std::vector<Token>& tokens, OutputBuffer& out) {
+        writeBinary(tokens, MsgpackEncoder(out));
+    }
+
+    void writeCbor(const std::vector<Token>& tokens, OutputBuffer& out) {
+        writeBinary(tokens, CborEncoder(out));
+    }
+
+    bool serialize(const std::vector<Token>& tokens, const std::string& format, OutputBuffer& out,
+                   SerializeStyle style) {
+        if (format == "json") {
+            writeJson(tokens, out, style);
+        } else if (format == "toml") {
+            writeToml(tokens, out, style);
+        } else if (format == "msgpack") {
+            writeMsgpack(tokens, out);
+        } else if (format == "cbor") {
+            writeCbor(tokens, out);
+        } else {
+            return false;
+        }
+        return true;
+    }
 
-            std::ostringstream oss;
-            oss << tbl;
-            return oss.str();
+    std::string serialize(const std::vector<Token>& tokens, const std::string& format, SerializeStyle style) {
+        std::ostringstream oss;
+        {
+            OutputBuffer out(oss);
+            serialize(tokens, format, out, style);
         }
-        return "";
+        return oss.str();
     }
-} // namespace dreamlang::lexer
\ No newline at end of file
+} // namespace dreamlang::lexer
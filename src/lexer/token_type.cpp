@@ -4,6 +4,7 @@ namespace dreamlang::lexer {
 
 const char* tokenTypeToString(TokenType type) {
     switch (type) {
+        case TokenType::ILLEGAL: return "ILLEGAL";
         case TokenType::IDENT: return "IDENT";
         case TokenType::NULL_LITERAL: return "NULL";
         case TokenType::NUMBER: return "NUMBER";
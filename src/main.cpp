@@ -1,14 +1,29 @@
+#include "lexer/content_hash.h"
 #include "lexer/lexical.h"
 #include "lexer/lexical_exception.h"
+#include "lexer/source_buffer.h"
+#include "lexer/stream_lexer.h"
+#include "lexer/token_cache.h"
+#include "lexer/token_format.h"
 #include "lexer/token_serialize.h"
 #include "i18n/locale_manager.h"
 #include "config/config_manager.h"
+#include "driver/source_files.h"
+#include "driver/thread_pool.h"
+#include "driver/token_manifest.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <sstream>
 
 void printUsage(const char* program_name) {
@@ -17,7 +32,7 @@ void printUsage(const char* program_name) {
     
     std::cout << locale_mgr.gettext("Usage") << ": " << program_name 
               << " [" << locale_mgr.gettext("options") << "] [<" 
-              << locale_mgr.gettext("source_file") << ".zv>]" << std::endl;
+              << locale_mgr.gettext("source_file") << ".zv|" << locale_mgr.gettext("directory") << "> ...]" << std::endl;
     std::cout << std::endl;
     std::cout << locale_mgr.gettext("Options") << ":" << std::endl;
     std::cout << "  -h, --help     " << locale_mgr.gettext("Show this help message") << std::endl;
@@ -25,9 +40,17 @@ void printUsage(const char* program_name) {
     std::cout << "  -l, --locale   " << locale_mgr.gettext("Set locale (e.g., zh_CN, en_US)") << std::endl;
     std::cout << "  -t, --tokens   " << locale_mgr.gettext("Show tokenization result") << std::endl;
     std::cout << "  -c, --config   " << locale_mgr.gettext("Set default config or specify config file") << std::endl;
+    std::cout << "  -f, --format   " << locale_mgr.gettext("Token export formats for -t, comma separated: json, toml, msgpack, cbor (default: json,toml)") << std::endl;
+    std::cout << "  --layout       " << locale_mgr.gettext("Token list layout for -t: default, aligned, tsv (tsv prints only the table to stdout)") << std::endl;
+    std::cout << "  --count        " << locale_mgr.gettext("Only count tokens, in total and by type, without building the token list") << std::endl;
+    std::cout << "  --check        " << locale_mgr.gettext("Only check that the sources lex, reporting nothing but errors") << std::endl;
+    std::cout << "  -j, --jobs     " << locale_mgr.gettext("Number of worker threads (default: number of CPUs)") << std::endl;
+    std::cout << "  --max-errors   " << locale_mgr.gettext("Maximum number of lexical errors reported per file (default: 20, 0 = unlimited)") << std::endl;
     std::cout << std::endl;
     std::cout << locale_mgr.gettext("Note") << ": " 
               << locale_mgr.gettext("If source file has no extension, .zv will be automatically appended.") << std::endl;
+    std::cout << "      " << locale_mgr.gettext("Directories are searched recursively for .zv files.") << std::endl;
+    std::cout << "      " << locale_mgr.gettext("Use - to read from standard input (streamed with constant memory).") << std::endl;
 }
 
 void printVersion() {
@@ -39,122 +62,553 @@ void printVersion() {
               << locale_mgr.gettext("Project") << std::endl;
 }
 
-std::string resolveSourceFile(const std::string& filename) {
+/**
+ * 打开源文件，普通文件直接映射到内存，不拷贝也不改写内容（CRLF 由词法分析器处理）
+ */
+void readFile(const std::string& filename, dreamlang::lexer::SourceBuffer& source) {
+    if (!source.open(filename)) {
+        using namespace dreamlang::i18n;
+        auto& locale_mgr = LocaleManager::getInstance();
+        throw std::runtime_error(locale_mgr.gettext("Cannot open file") + ": " + filename);
+    }
+}
+
+/**
+ * 每个文件默认最多报告的词法错误数
+ */
+constexpr size_t DEFAULT_MAX_ERRORS = 20;
+
+/**
+ * 显示Token时可以生成的导出格式，名称同时用作 serialize() 的格式名和文件扩展名
+ */
+struct ExportFormat {
+    const char* name;
+    const char* generated;
+    const char* up_to_date;
+};
+
+constexpr ExportFormat EXPORT_FORMATS[] = {
+    {"json", N_("JSON tokens file generated"), N_("JSON tokens file is up to date")},
+    {"toml", N_("TOML tokens file generated"), N_("TOML tokens file is up to date")},
+    {"msgpack", N_("MessagePack tokens file generated"), N_("MessagePack tokens file is up to date")},
+    {"cbor", N_("CBOR tokens file generated"), N_("CBOR tokens file is up to date")},
+};
+
+/**
+ * 按名称查找导出格式
+ * @return 未知格式时为空指针
+ */
+const ExportFormat* findExportFormat(const std::string& name) {
+    for (const auto& format : EXPORT_FORMATS) {
+        if (name == format.name) {
+            return &format;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * 处理源文件的方式
+ */
+enum class RunMode {
+    // 分析出完整的Token列表
+    TOKENIZE,
+    // 只统计Token总数和各类型的Token数
+    COUNT,
+    // 只检查能否通过词法分析
+    CHECK
+};
+
+/**
+ * 影响每个源文件处理方式的命令行选项
+ */
+struct RunOptions {
+    RunMode mode = RunMode::TOKENIZE;
+    bool show_tokens = false;
+    // 单个文件内部并行分析的线程数
+    unsigned threads = 1;
+    // 每个文件最多报告的词法错误数，为 0 时不限制
+    size_t max_errors = DEFAULT_MAX_ERRORS;
+    // 显示Token时生成的导出格式（二进制Token缓存总是生成）
+    std::vector<const ExportFormat*> formats = {&EXPORT_FORMATS[0], &EXPORT_FORMATS[1]};
+    // Token列表的布局
+    dreamlang::lexer::TokenLayout layout = dreamlang::lexer::TokenLayout::DEFAULT;
+    // Token列表直接写入的文件描述符，为 -1 时写入 FileResult::output
+    int output_fd = -1;
+    // .tokens 输出的清单，为空时总是重新生成
+    dreamlang::driver::ManifestCache* manifests = nullptr;
+};
+
+/**
+ * 单个源文件的处理结果
+ * 输出先写入缓冲区，多文件并行处理时再按命令行顺序打印
+ */
+struct FileResult {
+    std::string output;
+    std::string errors;
+    size_t bytes = 0;
+    size_t tokens = 0;
+    bool success = false;
+};
+
+/**
+ * 输出一个文件的全部词法诊断，达到上限时注明后面的错误没有报告
+ */
+void printDiagnostics(const std::vector<dreamlang::lexer::Diagnostic>& diagnostics, size_t max_errors,
+                      std::ostream& err) {
+    using namespace dreamlang::lexer;
     using namespace dreamlang::i18n;
-    // auto& locale_mgr = LocaleManager::getInstance();
-    
-    // 如果文件名已经有扩展名，直接使用
-    if (filename.find('.') != std::string::npos) {
-        return filename;
+
+    auto& locale_mgr = LocaleManager::getInstance();
+    for (const auto& diagnostic : diagnostics) {
+        err << locale_mgr.gettext("Lexical Error") << ": "
+            << LexicalException(diagnostic).getLocalizedMessage() << std::endl;
     }
-    
-    // 尝试添加 .zv 后缀
-    std::string zv_filename = filename + ".zv";
-    std::ifstream test_file(zv_filename);
-    if (test_file.good()) {
-        test_file.close();
-        return zv_filename;
+    if (max_errors != 0 && diagnostics.size() >= max_errors) {
+        err << locale_mgr.gettext("Error") << ": "
+            << locale_mgr.gettext("Too many lexical errors, stopping") << std::endl;
     }
-    
-    // 如果找不到 .zv 文件，返回原文件名（让后续错误处理处理）
-    return filename;
 }
 
-std::string readFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        using namespace dreamlang::i18n;
-        auto& locale_mgr = LocaleManager::getInstance();
-        throw std::runtime_error(locale_mgr.gettext("Cannot open file") + ": " + filename);
+/**
+ * 输出Token总数和各类型的Token数（只列出出现过的类型）
+ */
+void printTokenCounts(size_t total, const std::array<size_t, dreamlang::lexer::TOKEN_TYPE_COUNT>& counts,
+                      std::ostream& out) {
+    using namespace dreamlang::lexer;
+    using namespace dreamlang::i18n;
+
+    auto& locale_mgr = LocaleManager::getInstance();
+    std::ostringstream table;
+    table << locale_mgr.gettext("Total tokens") << ": " << total << std::endl;
+    table << locale_mgr.gettext("Tokens by type") << ":" << std::endl;
+    for (size_t type = 0; type < TOKEN_TYPE_COUNT; ++type) {
+        if (counts[type] != 0) {
+            table << "  " << std::left << std::setw(16) << tokenTypeToString(static_cast<TokenType>(type))
+                  << counts[type] << std::endl;
+        }
     }
-    
-    std::string content;
-    std::string line;
-    while (std::getline(file, line)) {
-        content += line + "\n";
+    out << table.str();
+}
+
+/**
+ * 各模式共用的词法分析选项：Token直接引用源码，词法错误不中断分析
+ */
+dreamlang::lexer::LexerOptions lexerOptions(const RunOptions& run_options) {
+    dreamlang::lexer::LexerOptions options;
+    options.value_mode = dreamlang::lexer::TokenValueMode::VIEW;
+    options.recover_errors = true;
+    options.max_errors = run_options.max_errors;
+    return options;
+}
+
+/**
+ * --count 和 --check：只运行词法分析的状态机，不构造Token列表，也不解码字面量
+ */
+void scanAndPrint(std::string_view source_code, FileResult& result, const RunOptions& run_options) {
+    using namespace dreamlang::lexer;
+
+    LexerOptions options = lexerOptions(run_options);
+    Lexical lexer = Lexical::borrowed(source_code, options);
+    ScanSummary summary = lexer.scan();
+
+    std::ostringstream out;
+    if (!lexer.getDiagnostics().empty()) {
+        printDiagnostics(lexer.getDiagnostics(), run_options.max_errors, out);
+        result.errors += out.str();
+        return;
     }
-    
-    return content;
+    result.tokens = summary.tokens;
+    result.success = true;
+    if (run_options.mode == RunMode::COUNT) {
+        printTokenCounts(summary.tokens, summary.counts, out);
+        result.output += out.str();
+    }
+}
+
+/**
+ * 一个源文件在 .tokens 目录中的输出文件
+ */
+struct TokenOutputs {
+    std::filesystem::path dir;
+    // 源文件名（不含目录），即清单中的记录名
+    std::string name;
+    // 输出文件名（不含扩展名）
+    std::string base_name;
+    std::filesystem::path cache;
+
+    /**
+     * 获取导出格式对应的输出文件
+     */
+    std::filesystem::path file(const ExportFormat& format) const {
+        return dir / (base_name + "." + format.name);
+    }
+};
+
+TokenOutputs tokenOutputs(const std::string& source_filename) {
+    using namespace dreamlang::lexer;
+
+    // 获取源文件的目录和基础名称
+    std::filesystem::path source_path(source_filename);
+    std::filesystem::path source_dir = source_path.parent_path();
+    std::string base_name = source_path.stem().string();
+
+    // 如果源文件在当前目录，source_dir会是空的，需要设置为当前目录
+    if (source_dir.empty()) {
+        source_dir = ".";
+    }
+
+    TokenOutputs outputs;
+    outputs.dir = source_dir / ".tokens";
+    outputs.name = source_path.filename().string();
+    outputs.base_name = base_name;
+    outputs.cache = outputs.dir / (base_name + TOKEN_CACHE_EXTENSION);
+    return outputs;
+}
+
+/**
+ * 把Token列表写入输出缓冲区，TSV 布局只写表格本身
+ */
+void writeTokenList(const std::vector<dreamlang::lexer::Token>& tokens, dreamlang::lexer::TokenLayout layout,
+                    dreamlang::lexer::OutputBuffer& out) {
+    using namespace dreamlang::lexer;
+    using namespace dreamlang::i18n;
+
+    auto& locale_mgr = LocaleManager::getInstance();
+    bool decorated = layout != TokenLayout::TSV;
+    if (decorated) {
+        out.write(locale_mgr.gettext("Tokenization result"));
+        out.write(":\n===========================================\n");
+    }
+    formatTokenHeader(out, layout);
+
+    for (const auto& token : tokens) {
+        if (token.getType() != TokenType::LINEBREAK) {
+            formatToken(token, out, layout);
+            out.put('\n');
+        }
+    }
+
+    if (decorated) {
+        out.write("===========================================\n");
+        out.write(locale_mgr.gettext("Total tokens"));
+        out.write(": ");
+        out.writeInteger(static_cast<int64_t>(tokens.size()));
+        out.put('\n');
+    }
+}
+
+/**
+ * 输出Token列表：逐个格式化到一个大缓冲区，满了才整块写出，不经过 iostream
+ * 设置了 output_fd 时直接写入该文件描述符，否则追加到 result.output
+ */
+void printTokenList(const std::vector<dreamlang::lexer::Token>& tokens, const RunOptions& run_options,
+                    FileResult& result) {
+    using dreamlang::lexer::OutputBuffer;
+
+    if (run_options.output_fd >= 0) {
+        OutputBuffer out(run_options.output_fd, OutputBuffer::DEFAULT_CAPACITY * 16);
+        writeTokenList(tokens, run_options.layout, out);
+    } else {
+        OutputBuffer out(result.output, OutputBuffer::DEFAULT_CAPACITY * 16);
+        writeTokenList(tokens, run_options.layout, out);
+    }
+}
+
+/**
+ * 源码与清单中的记录一致且输出文件都在时，直接从二进制缓存还原Token并打印，不重新分析和生成
+ * @return 是否使用了缓存
+ */
+bool printCachedTokens(std::string_view source_code, uint64_t source_hash, const TokenOutputs& outputs,
+                       const RunOptions& run_options, std::ostream& out, FileResult& result) {
+    using namespace dreamlang::lexer;
+    using namespace dreamlang::i18n;
+
+    std::optional<dreamlang::driver::ManifestEntry> entry = run_options.manifests->find(outputs.dir, outputs.name);
+    if (!entry || entry->hash != source_hash || entry->size != source_code.size()) {
+        return false;
+    }
+    for (const ExportFormat* format : run_options.formats) {
+        std::error_code error;
+        if (!std::filesystem::exists(outputs.file(*format), error)) {
+            return false;
+        }
+    }
+    // 缓存文件自身也记录了源码的哈希和词法分析选项，防止清单和输出文件不同步；哈希已经算过，不调用 matches()
+    TokenCacheReader reader;
+    if (!reader.open(outputs.cache.string()) || reader.header().source_hash != source_hash ||
+        reader.header().source_size != source_code.size() ||
+        reader.header().lexer_options != tokenCacheOptions(lexerOptions(run_options)) ||
+        reader.size() != entry->tokens) {
+        return false;
+    }
+
+    auto& locale_mgr = LocaleManager::getInstance();
+    std::vector<Token> tokens = reader.tokens(source_code);
+    printTokenList(tokens, run_options, result);
+    for (const ExportFormat* format : run_options.formats) {
+        out << locale_mgr.gettext(format->up_to_date) << ": " << outputs.file(*format) << std::endl;
+    }
+    out << locale_mgr.gettext("Binary tokens file is up to date") << ": " << outputs.cache << std::endl;
+    result.tokens = tokens.size();
+    result.success = true;
+    return true;
 }
 
-void tokenizeAndPrint(const std::string& source_code, bool show_tokens = false, const std::string& source_filename = "") {
+void tokenizeAndPrint(std::string_view source_code, FileResult& result, const RunOptions& run_options,
+                      const std::string& source_filename = "") {
     using namespace dreamlang::lexer;
     using namespace dreamlang::i18n;
+    using dreamlang::driver::writeFileAtomically;
     
     auto& locale_mgr = LocaleManager::getInstance();
+    std::ostringstream out;
+    std::ostringstream err;
+
+    // 生成 .tokens 输出时，源码没有变化就直接使用上次的结果
+    bool write_outputs = run_options.show_tokens && !source_filename.empty();
+    bool use_manifest = write_outputs && run_options.manifests != nullptr;
+    uint64_t source_hash = use_manifest ? contentHash(source_code) : 0;
+    // TSV 布局的标准输出只有表格，其他提示写入标准错误
+    std::string& status = run_options.layout == TokenLayout::TSV ? result.errors : result.output;
+    if (use_manifest && printCachedTokens(source_code, source_hash, tokenOutputs(source_filename), run_options,
+                                          out, result)) {
+        status += out.str();
+        return;
+    }
     
-    try {
-        Lexical lexer(source_code);
-        std::vector<Token> tokens = lexer.tokenize();
+    // 源码缓冲区的生命周期覆盖整个函数，lexer 和 Token 都直接引用它而无需拷贝
+    // 词法错误不会中断分析，一次报告文件中的全部错误
+    LexerOptions options = lexerOptions(run_options);
+    Lexical lexer = Lexical::borrowed(source_code, options);
+    std::vector<Token> tokens = lexer.tokenizeParallel(run_options.threads);
+
+    if (!lexer.getDiagnostics().empty()) {
+        printDiagnostics(lexer.getDiagnostics(), run_options.max_errors, err);
+    } else {
+        result.tokens = tokens.size();
         
-        if (show_tokens) {
-            std::cout << locale_mgr.gettext("Tokenization result") << ":" << std::endl;
-            std::cout << "===========================================" << std::endl;
-            
-            for (const auto& token : tokens) {
-                if (token.getType() != TokenType::LINEBREAK) {
-                    std::cout << token.toString() << std::endl;
-                }
-            }
-            
-            std::cout << "===========================================" << std::endl;
-            std::cout << locale_mgr.gettext("Total tokens") << ": " << tokens.size() << std::endl;
+        if (run_options.show_tokens) {
+            printTokenList(tokens, run_options, result);
 
-            // 当显示token时，同时生成JSON和TOML文件
-            if (!source_filename.empty()) {
+            // 当显示token时，同时生成 --format 指定格式的文件（默认JSON和TOML）
+            // 每个文件先写入临时文件再重命名，中断或并发运行不会留下写了一半的输出
+            if (write_outputs) {
                 try {
-                    // 获取源文件的目录和基础名称
-                    std::filesystem::path source_path(source_filename);
-                    std::filesystem::path source_dir = source_path.parent_path();
-                    std::string base_name = source_path.stem().string();
-
-                    // 如果源文件在当前目录，source_dir会是空的，需要设置为当前目录
-                    if (source_dir.empty()) {
-                        source_dir = ".";
-                    }
+                    TokenOutputs outputs = tokenOutputs(source_filename);
 
                     // 在源文件目录下创建.tokens目录
-                    std::filesystem::path tokens_dir = source_dir / ".tokens";
-                    if (!std::filesystem::exists(tokens_dir)) {
-                        std::filesystem::create_directories(tokens_dir);
+                    if (!std::filesystem::exists(outputs.dir)) {
+                        std::filesystem::create_directories(outputs.dir);
+                    }
+
+                    // 生成各导出格式的文件，边生成边写入，不在内存中保留完整内容
+                    bool all_written = true;
+                    for (const ExportFormat* format : run_options.formats) {
+                        std::filesystem::path path = outputs.file(*format);
+                        bool written = writeFileAtomically(path, [&](std::ostream& file) {
+                            OutputBuffer buffer(file);
+                            serialize(tokens, format->name, buffer);
+                        });
+                        if (written) {
+                            out << locale_mgr.gettext(format->generated) << ": " << path << std::endl;
+                        } else {
+                            all_written = false;
+                        }
                     }
 
-                    // 生成JSON文件
-                    std::string json_content = serialize(tokens, "json");
-                    std::filesystem::path json_filename = tokens_dir / (base_name + ".json");
-                    std::ofstream json_file(json_filename);
-                    if (json_file.is_open()) {
-                        json_file << json_content;
-                        json_file.close();
-                        std::cout << locale_mgr.gettext("JSON tokens file generated") << ": " << json_filename << std::endl;
+                    // 生成二进制Token缓存，其他工具可以直接映射使用，源码未变时无需重新分析
+                    if (writeFileAtomically(outputs.cache, encodeTokenCache(tokens, source_code, options))) {
+                        out << locale_mgr.gettext("Binary tokens file generated") << ": " << outputs.cache << std::endl;
+                    } else {
+                        all_written = false;
                     }
 
-                    // 生成TOML文件
-                    std::string toml_content = serialize(tokens, "toml");
-                    std::filesystem::path toml_filename = tokens_dir / (base_name + ".toml");
-                    std::ofstream toml_file(toml_filename);
-                    if (toml_file.is_open()) {
-                        toml_file << toml_content;
-                        toml_file.close();
-                        std::cout << locale_mgr.gettext("TOML tokens file generated") << ": " << toml_filename << std::endl;
+                    // 只有全部输出都已更新才记入清单
+                    if (all_written && use_manifest) {
+                        run_options.manifests->update(outputs.dir, outputs.name,
+                                                      {source_hash, source_code.size(), tokens.size()});
                     }
 
                 } catch (const std::exception& e) {
-                    std::cerr << locale_mgr.gettext("Warning") << ": "
-                              << locale_mgr.gettext("Failed to generate token files") << " - " << e.what() << std::endl;
+                    err << locale_mgr.gettext("Warning") << ": "
+                        << locale_mgr.gettext("Failed to generate token files") << " - " << e.what() << std::endl;
                 }
             }
         } else {
-            std::cout << locale_mgr.gettext("Lexical analysis completed successfully") 
-                      << ". " << locale_mgr.gettext("Found") << " " << tokens.size() 
-                      << " " << locale_mgr.gettext("tokens") << "." << std::endl;
+            out << locale_mgr.gettext("Lexical analysis completed successfully") 
+                << ". " << locale_mgr.gettext("Found") << " " << tokens.size() 
+                << " " << locale_mgr.gettext("tokens") << "." << std::endl;
+        }
+        result.success = true;
+    }
+
+    status += out.str();
+    result.errors += err.str();
+}
+
+/**
+ * 流式分析标准输入，Token 边读边写入 out，内存占用与输入长度无关
+ * 不生成 .tokens 文件（那需要完整的 Token 列表）
+ */
+FileResult tokenizeStreamAndPrint(const RunOptions& run_options, std::ostream& out) {
+    using namespace dreamlang::lexer;
+    using namespace dreamlang::i18n;
+
+    auto& locale_mgr = LocaleManager::getInstance();
+    FileResult result;
+    LexerOptions options = lexerOptions(run_options);
+    StreamLexer lexer(0, options); // 文件描述符 0 即标准输入
+    bool show_tokens = run_options.show_tokens;
+    std::array<size_t, TOKEN_TYPE_COUNT> counts{};
+    bool decorated = show_tokens && run_options.layout != TokenLayout::TSV;
+
+    try {
+        if (decorated) {
+            out << locale_mgr.gettext("Tokenization result") << ":" << std::endl;
+            out << "===========================================" << std::endl;
+        }
+        {
+            OutputBuffer listing(out);
+            if (show_tokens) {
+                formatTokenHeader(listing, run_options.layout);
+            }
+            result.tokens = lexer.run([&](const Token& token) {
+                ++counts[static_cast<size_t>(token.getType())];
+                if (show_tokens && token.getType() != TokenType::LINEBREAK) {
+                    formatToken(token, listing, run_options.layout);
+                    listing.put('\n');
+                }
+            });
+        }
+        if (!lexer.getDiagnostics().empty()) {
+            // 已输出的 Token 中出错的部分是 ILLEGAL，错误汇总到最后
+            out.flush();
+            std::ostringstream err;
+            printDiagnostics(lexer.getDiagnostics(), run_options.max_errors, err);
+            result.errors += err.str();
+        } else if (decorated) {
+            out << "===========================================" << std::endl;
+            out << locale_mgr.gettext("Total tokens") << ": " << result.tokens << std::endl;
+        } else if (run_options.mode == RunMode::COUNT) {
+            printTokenCounts(result.tokens, counts, out);
+        } else if (!show_tokens && run_options.mode == RunMode::TOKENIZE) {
+            out << locale_mgr.gettext("Lexical analysis completed successfully") 
+                << ". " << locale_mgr.gettext("Found") << " " << result.tokens 
+                << " " << locale_mgr.gettext("tokens") << "." << std::endl;
+        }
+        result.success = lexer.getDiagnostics().empty();
+    } catch (const std::exception& e) {
+        out.flush();
+        result.errors += locale_mgr.gettext("Error") + ": " + e.what() + "\n";
+    }
+    result.bytes = lexer.bytesRead();
+    return result;
+}
+
+/**
+ * 处理一个源文件（标准输入由调用者用 tokenizeStreamAndPrint 直接流式输出）
+ */
+FileResult processFile(const std::string& filename, const RunOptions& run_options) {
+    using namespace dreamlang::i18n;
+
+    FileResult result;
+    try {
+        dreamlang::lexer::SourceBuffer source;
+        readFile(filename, source);
+        result.bytes = source.size();
+        if (run_options.mode == RunMode::TOKENIZE) {
+            tokenizeAndPrint(source.view(), result, run_options, filename);
+        } else {
+            scanAndPrint(source.view(), result, run_options);
+        }
+    } catch (const std::exception& e) {
+        auto& locale_mgr = LocaleManager::getInstance();
+        result.errors += locale_mgr.gettext("Error") + ": " + e.what() + "\n";
+    }
+    return result;
+}
+
+/**
+ * 在工作窃取线程池上处理多个源文件
+ * 每个文件的输出在其之前的文件全部打印后立即打印，顺序与命令行一致，与线程调度无关。
+ * 标准输入不交给线程池：轮到它时由打印线程直接流式分析并输出，内存占用与输入长度无关
+ * @return 失败的文件数
+ */
+size_t processFiles(const std::vector<std::string>& files, RunOptions run_options, unsigned jobs) {
+    using namespace dreamlang::i18n;
+    using namespace dreamlang::driver;
+    
+    auto& locale_mgr = LocaleManager::getInstance();
+    auto start_time = std::chrono::steady_clock::now();
+
+    std::vector<FileResult> results(files.size());
+    std::vector<bool> finished(files.size(), false);
+    std::mutex finished_mutex;
+    std::condition_variable finished_cv;
+
+    // 并行在文件之间进行，单个文件内部不再分线程
+    run_options.threads = 1;
+    ThreadPool pool(jobs);
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (files[i] == STDIN_SOURCE) {
+            continue;
+        }
+        pool.submit([&, i] {
+            FileResult result = processFile(files[i], run_options);
+            std::lock_guard<std::mutex> lock(finished_mutex);
+            results[i] = std::move(result);
+            finished[i] = true;
+            finished_cv.notify_all();
+        });
+    }
+
+    size_t total_bytes = 0;
+    size_t total_tokens = 0;
+    size_t failures = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        FileResult result;
+        if (files[i] == STDIN_SOURCE) {
+            // 之前的文件都已打印，此时只有本线程写标准输出，直接流式输出而不缓存
+            // （--check 时只有出错才有输出，文件名在出错后再打印）
+            if (run_options.mode != RunMode::CHECK) {
+                std::cout << "==> " << files[i] << " <==" << std::endl;
+            }
+            result = tokenizeStreamAndPrint(run_options, std::cout);
+            if (run_options.mode == RunMode::CHECK && !result.errors.empty()) {
+                std::cout << "==> " << files[i] << " <==" << std::endl;
+            }
+        } else {
+            {
+                std::unique_lock<std::mutex> lock(finished_mutex);
+                finished_cv.wait(lock, [&] { return finished[i]; });
+                result = std::move(results[i]);
+            }
+            // --check 时通过检查的文件没有任何输出，连同文件名一起省略
+            if (!result.output.empty() || !result.errors.empty()) {
+                std::cout << "==> " << files[i] << " <==" << std::endl;
+            }
+        }
+        std::cout << result.output;
+        std::cout.flush();
+        std::cerr << result.errors;
+        total_bytes += result.bytes;
+        total_tokens += result.tokens;
+        if (!result.success) {
+            ++failures;
         }
-        
-    } catch (const LexicalException& e) {
-        std::cerr << locale_mgr.gettext("Lexical Error") << ": " 
-                  << e.getLocalizedMessage() << std::endl;
-        exit(1);
     }
+    pool.wait();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::cout << "===========================================" << std::endl;
+    std::cout << locale_mgr.gettext("Files") << ": " << files.size() << std::endl;
+    std::cout << locale_mgr.gettext("Failures") << ": " << failures << std::endl;
+    std::cout << locale_mgr.gettext("Total bytes") << ": " << total_bytes << std::endl;
+    std::cout << locale_mgr.gettext("Total tokens") << ": " << total_tokens << std::endl;
+    std::cout << locale_mgr.gettext("Wall time") << ": " << std::fixed << std::setprecision(3)
+              << seconds << "s" << std::endl;
+    return failures;
 }
 
 int main(int argc, char* argv[]) {
@@ -212,12 +666,13 @@ int main(int argc, char* argv[]) {
     }
     
     // 解析命令行参数
-    std::string source_file;
+    std::vector<std::string> source_inputs;
     std::string custom_locale;
     std::string custom_config;
     bool show_help = false;
     bool show_version = false;
-    bool show_tokens = false;
+    RunOptions run_options;
+    unsigned jobs = 0;
     
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
@@ -227,7 +682,11 @@ int main(int argc, char* argv[]) {
         } else if (arg == "-v" || arg == "--version") {
             show_version = true;
         } else if (arg == "-t" || arg == "--tokens") {
-            show_tokens = true;
+            run_options.show_tokens = true;
+        } else if (arg == "--count") {
+            run_options.mode = RunMode::COUNT;
+        } else if (arg == "--check") {
+            run_options.mode = RunMode::CHECK;
         } else if (arg == "-c" || arg == "--config") {
             if (i + 1 < argc) {
                 custom_config = argv[++i];
@@ -236,6 +695,62 @@ int main(int argc, char* argv[]) {
                           << locale_mgr.gettext("Option --config requires an argument") << std::endl;
                 return 1;
             }
+        } else if (arg == "-f" || arg == "--format") {
+            run_options.formats.clear();
+            bool valid = i + 1 < argc;
+            if (valid) {
+                std::istringstream list(argv[++i]);
+                std::string name;
+                while (std::getline(list, name, ',')) {
+                    const ExportFormat* format = findExportFormat(name);
+                    if (format == nullptr) {
+                        valid = false;
+                    } else if (std::find(run_options.formats.begin(), run_options.formats.end(), format) ==
+                               run_options.formats.end()) {
+                        run_options.formats.push_back(format);
+                    }
+                }
+            }
+            if (!valid || run_options.formats.empty()) {
+                std::cerr << locale_mgr.gettext("Error") << ": " 
+                          << locale_mgr.gettext("Option --format requires a comma separated list of json, toml, msgpack, cbor") << std::endl;
+                return 1;
+            }
+        } else if (arg == "--layout") {
+            std::string layout = i + 1 < argc ? argv[++i] : "";
+            if (layout == "default") {
+                run_options.layout = dreamlang::lexer::TokenLayout::DEFAULT;
+            } else if (layout == "aligned") {
+                run_options.layout = dreamlang::lexer::TokenLayout::ALIGNED;
+            } else if (layout == "tsv") {
+                run_options.layout = dreamlang::lexer::TokenLayout::TSV;
+            } else {
+                std::cerr << locale_mgr.gettext("Error") << ": " 
+                          << locale_mgr.gettext("Option --layout requires one of default, aligned, tsv") << std::endl;
+                return 1;
+            }
+        } else if (arg == "-j" || arg == "--jobs") {
+            int value = 0;
+            if (i + 1 < argc) {
+                std::istringstream(argv[++i]) >> value;
+            }
+            if (value <= 0) {
+                std::cerr << locale_mgr.gettext("Error") << ": " 
+                          << locale_mgr.gettext("Option --jobs requires a positive integer") << std::endl;
+                return 1;
+            }
+            jobs = static_cast<unsigned>(value);
+        } else if (arg == "--max-errors") {
+            long long value = -1;
+            if (i + 1 < argc && !(std::istringstream(argv[++i]) >> value)) {
+                value = -1;
+            }
+            if (value < 0) {
+                std::cerr << locale_mgr.gettext("Error") << ": " 
+                          << locale_mgr.gettext("Option --max-errors requires a non-negative integer") << std::endl;
+                return 1;
+            }
+            run_options.max_errors = static_cast<size_t>(value);
         } else if (arg == "-l" || arg == "--locale") {
             if (i + 1 < argc) {
                 custom_locale = argv[++i];
@@ -244,26 +759,20 @@ int main(int argc, char* argv[]) {
                           << locale_mgr.gettext("Option --locale requires an argument") << std::endl;
                 return 1;
             }
-        } else if (arg[0] == '-') {
+        } else if (arg[0] == '-' && arg != dreamlang::driver::STDIN_SOURCE) {
             std::cerr << locale_mgr.gettext("Error") << ": " 
                       << locale_mgr.gettext("Unknown option") << " '" << arg << "'" << std::endl;
             printUsage(argv[0]);
             return 1;
         } else {
-            if (source_file.empty()) {
-                source_file = arg;
-            } else {
-                std::cerr << locale_mgr.gettext("Error") << ": " 
-                          << locale_mgr.gettext("Multiple source files specified") << std::endl;
-                return 1;
-            }
+            source_inputs.push_back(arg);
         }
     }
     
     // 如果指定了自定义配置文件，重新加载配置
     if (!custom_config.empty()) {
         // 检查是否只指定了配置文件而没有源文件（设置默认配置模式）
-        if (source_file.empty() && !show_help && !show_version) {
+        if (source_inputs.empty() && !show_help && !show_version) {
             // 设置默认配置模式
             if (config_mgr.setAsDefaultConfig(custom_config)) {
                 std::cout << locale_mgr.gettext("Default config set successfully") << ": " 
@@ -311,19 +820,66 @@ int main(int argc, char* argv[]) {
         return 0;
     }
     
-    if (source_file.empty()) {
+    if (run_options.mode != RunMode::TOKENIZE && run_options.show_tokens) {
+        std::cerr << locale_mgr.gettext("Error") << ": " 
+                  << locale_mgr.gettext("Options --count and --check cannot be used with --tokens") << std::endl;
+        return 1;
+    }
+
+    if (source_inputs.empty()) {
         std::cerr << locale_mgr.gettext("Error") << ": " 
                   << locale_mgr.gettext("No source file specified") << std::endl;
         printUsage(argv[0]);
         return 1;
     }
     
-    try {
-        std::string resolved_file = resolveSourceFile(source_file);
-        std::string source_code = readFile(resolved_file);
-        tokenizeAndPrint(source_code, show_tokens, resolved_file);
-    } catch (const std::exception& e) {
-        std::cerr << locale_mgr.gettext("Error") << ": " << e.what() << std::endl;
+    // 显示Token时生成的 .tokens 输出按内容哈希缓存；词法分析器或输出格式变化时 key 随之改变，旧的记录全部失效
+    std::unique_ptr<dreamlang::driver::ManifestCache> manifests;
+    if (run_options.show_tokens) {
+        std::string outputs;
+        for (const ExportFormat* format : run_options.formats) {
+            outputs += std::string(format->name) + ",";
+        }
+        manifests = std::make_unique<dreamlang::driver::ManifestCache>(
+                "lexer=" + std::to_string(dreamlang::lexer::LEXER_OUTPUT_VERSION) +
+                " serialize=" + std::to_string(dreamlang::lexer::TOKEN_SERIALIZE_VERSION) +
+                " cache=" + std::to_string(dreamlang::lexer::TOKEN_CACHE_VERSION) + " outputs=" + outputs + "dltok");
+        run_options.manifests = manifests.get();
+    }
+
+    bool has_directory = false;
+    std::vector<std::string> source_files = dreamlang::driver::collectSourceFiles(source_inputs, has_directory);
+    
+    // 单个文件保持原有输出格式，线程用于文件内的并行词法分析
+    if (source_files.size() == 1 && !has_directory) {
+        // 标准输入直接流式输出，不在内存中缓冲；文件的Token列表也直接写入标准输出
+        run_options.threads = jobs;
+        std::cout.flush();
+        run_options.output_fd = 1; // 文件描述符 1 即标准输出
+        FileResult result = source_files.front() == dreamlang::driver::STDIN_SOURCE
+                ? tokenizeStreamAndPrint(run_options, std::cout)
+                : processFile(source_files.front(), run_options);
+        // 清单写入失败只会让下次运行重新生成输出
+        if (manifests) {
+            manifests->save();
+        }
+        std::cout << result.output;
+        std::cout.flush();
+        std::cerr << result.errors;
+        return result.success ? 0 : 1;
+    }
+    
+    if (source_files.empty()) {
+        std::cerr << locale_mgr.gettext("Error") << ": " 
+                  << locale_mgr.gettext("No .zv source files found") << std::endl;
+        return 1;
+    }
+    
+    size_t failures = processFiles(source_files, run_options, jobs);
+    if (manifests) {
+        manifests->save();
+    }
+    if (failures > 0) {
         return 1;
     }
     
@@ -0,0 +1,40 @@
+# Runs dreamlang with and without --check on the same inputs and requires identical errors and exit codes.
+# Usage: cmake -DDREAMLANG=<executable> -DSOURCE_DIR=<repository> -DWORK_DIR=<scratch directory> -P <this file>
+
+file(MAKE_DIRECTORY "${WORK_DIR}")
+file(WRITE "${WORK_DIR}/many_errors.zv" [=[
+var ok = "fine" ** 2 && b || c <= d
+a & b | c
+"bad \q escape" 0x 0b2 0o9 1e 9223372036854775808 1e999 @ # $
+'ab' '
+"open
+/* never closed
+]=])
+file(GLOB examples "${SOURCE_DIR}/examples/*.zv")
+set(inputs ${examples} "${WORK_DIR}/many_errors.zv")
+
+function(compare_runs description)
+    execute_process(COMMAND "${DREAMLANG}" ${ARGN}
+        WORKING_DIRECTORY "${WORK_DIR}"
+        RESULT_VARIABLE tokenize_result
+        OUTPUT_QUIET
+        ERROR_VARIABLE tokenize_errors)
+    execute_process(COMMAND "${DREAMLANG}" --check ${ARGN}
+        WORKING_DIRECTORY "${WORK_DIR}"
+        RESULT_VARIABLE check_result
+        OUTPUT_QUIET
+        ERROR_VARIABLE check_errors)
+    if(NOT tokenize_result STREQUAL check_result OR NOT tokenize_errors STREQUAL check_errors)
+        message(FATAL_ERROR "--check differs from tokenizing (${description}):\n"
+            "exit code ${tokenize_result} vs ${check_result}\n"
+            "--- tokenize\n${tokenize_errors}--- check\n${check_errors}")
+    endif()
+    if(tokenize_result EQUAL 0)
+        message(FATAL_ERROR "expected lexical errors (${description})")
+    endif()
+endfunction()
+
+foreach(max_errors 0 1 3 20)
+    compare_runs("--max-errors ${max_errors}" --max-errors ${max_errors} ${inputs})
+    compare_runs("--max-errors ${max_errors}, one job" -j 1 --max-errors ${max_errors} ${inputs})
+endforeach()
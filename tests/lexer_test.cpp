@@ -0,0 +1,821 @@
+#include "driver/thread_pool.h"
+#include "lexer/lexical.h"
+#include "lexer/lexical_exception.h"
+#include "lexer/stream_lexer.h"
+#include "lexer/symbol_table.h"
+#include "lexer/token_cache.h"
+#include "test_support.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// 词法分析器的回归测试
+
+namespace {
+
+using namespace dreamlang::lexer;
+using dreamlang::test::failures;
+
+/**
+ * 以恢复模式分析源码，按 track_positions 决定是否在扫描时维护行号
+ */
+LexResult lex(std::string_view source, LexerBackend backend, bool track_positions) {
+    LexerOptions options;
+    options.value_mode = TokenValueMode::VIEW;
+    options.backend = backend;
+    options.track_positions = track_positions;
+    options.recover_errors = true;
+    return Lexical::borrowed(source, options).tryTokenize();
+}
+
+/**
+ * 一次 tokenize() 的全部可观察结果：Token、诊断信息，或非恢复模式下抛出的异常
+ */
+struct LexOutcome {
+    std::vector<Token> tokens;
+    std::vector<Diagnostic> diagnostics;
+    bool threw = false;
+    std::string error_type;
+    int error_line = 0;
+    int error_column = 0;
+    char error_char = '\0';
+};
+
+LexOutcome lexOutcome(const std::string& source, const LexerOptions& options) {
+    LexOutcome outcome;
+    Lexical lexer = Lexical::borrowed(source, options);
+    try {
+        outcome.tokens = lexer.tokenize();
+    } catch (const LexicalException& e) {
+        outcome.threw = true;
+        outcome.error_type = e.getErrorType();
+        outcome.error_line = e.getLine();
+        outcome.error_column = e.getColumn();
+        outcome.error_char = e.getErrorChar();
+    }
+    outcome.diagnostics = lexer.getDiagnostics();
+    return outcome;
+}
+
+/**
+ * 比较两个Token的类型、值、行号、偏移和数字字面量的值
+ */
+bool sameToken(const Token& a, const Token& b) {
+    if (a.getType() != b.getType() || a.getValue() != b.getValue() || a.getLine() != b.getLine() ||
+        a.getOffset() != b.getOffset() || a.getNumberForm() != b.getNumberForm()) {
+        return false;
+    }
+    if (a.getNumberForm() == NumberForm::INTEGER) {
+        return a.getInteger() == b.getInteger();
+    }
+    return a.getNumberForm() != NumberForm::FLOAT || a.getFloat() == b.getFloat();
+}
+
+bool sameTokens(const std::vector<Token>& a, const std::vector<Token>& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), sameToken);
+}
+
+bool sameDiagnostics(const std::vector<Diagnostic>& a, const std::vector<Diagnostic>& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const Diagnostic& x, const Diagnostic& y) {
+               return x.code == y.code && x.offset == y.offset && x.line == y.line && x.column == y.column &&
+                      x.character == y.character;
+           });
+}
+
+bool sameOutcome(const LexOutcome& a, const LexOutcome& b) {
+    return a.threw == b.threw && a.error_type == b.error_type && a.error_line == b.error_line &&
+           a.error_column == b.error_column && a.error_char == b.error_char && sameTokens(a.tokens, b.tokens) &&
+           sameDiagnostics(a.diagnostics, b.diagnostics);
+}
+
+/**
+ * 输出源码，不可见字符转义，便于定位失败的输入
+ */
+std::string printable(std::string_view text) {
+    std::string result;
+    for (unsigned char c : text) {
+        if (c >= 0x20 && c < 0x7F && c != '\\') {
+            result += static_cast<char>(c);
+        } else {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\x%02X", c);
+            result += escaped;
+        }
+    }
+    return result;
+}
+
+/**
+ * 扫描时记录的行号与按偏移查询的行号一致：都是Token的起始行
+ */
+void testTokenLinesMatchLazyLines() {
+    // 跨行字符串、换行Token、跨行的 ILLEGAL Token（含无效转义的字符串）和其后的诊断
+    const std::string source = "var a = \"one\ntwo\"\nb\n\"bad \\q\nend\" c\n'x'";
+
+    for (LexerBackend backend : {LexerBackend::SWITCH, LexerBackend::TABLE}) {
+        LexResult eager = lex(source, backend, true);
+        LexResult lazy = lex(source, backend, false);
+        Lexical positions = Lexical::borrowed(source);
+
+        CHECK_EQ(eager.tokens.size(), lazy.tokens.size());
+        for (size_t i = 0; i < eager.tokens.size() && i < lazy.tokens.size(); ++i) {
+            CHECK_EQ(eager.tokens[i].getOffset(), lazy.tokens[i].getOffset());
+            CHECK_EQ(eager.tokens[i].getLine(), positions.lineOf(lazy.tokens[i].getOffset()));
+        }
+
+        // var a = "one\ntwo" 的字符串从第 1 行开始，其后的换行Token在第 2 行
+        CHECK_EQ(static_cast<int>(eager.tokens[3].getType()), static_cast<int>(TokenType::STRING));
+        CHECK_EQ(eager.tokens[3].getLine(), 1);
+        CHECK_EQ(static_cast<int>(eager.tokens[4].getType()), static_cast<int>(TokenType::LINEBREAK));
+        CHECK_EQ(eager.tokens[4].getLine(), 2);
+        // "bad \q\nend" 从第 4 行开始
+        CHECK_EQ(static_cast<int>(eager.tokens[7].getType()), static_cast<int>(TokenType::ILLEGAL));
+        CHECK_EQ(eager.tokens[7].getLine(), 4);
+
+        CHECK_EQ(eager.diagnostics.size(), lazy.diagnostics.size());
+        for (size_t i = 0; i < eager.diagnostics.size() && i < lazy.diagnostics.size(); ++i) {
+            CHECK_EQ(eager.diagnostics[i].line, lazy.diagnostics[i].line);
+            CHECK_EQ(eager.diagnostics[i].column, lazy.diagnostics[i].column);
+        }
+    }
+}
+
+/**
+ * 生成足够切成多块并行分析的源码，每隔 every 行有一个非法字符
+ */
+std::string parallelSource(size_t lines, size_t every) {
+    std::string source;
+    for (size_t i = 0; i < lines; ++i) {
+        source += i % every == every - 1 ? "var a = b @ 1\n" : "var count_" + std::to_string(i % 97) + " = 0x1F + \"s\"\n";
+    }
+    return source;
+}
+
+/**
+ * 同一个词法分析器上重复并行分析，结果与新的词法分析器相同，不残留上一次的诊断信息和停止状态
+ */
+void testParallelStartsFresh() {
+    const std::string source = parallelSource(40000, 5000);
+    LexerOptions options;
+    options.value_mode = TokenValueMode::VIEW;
+    options.recover_errors = true;
+    options.max_errors = 3;
+
+    std::vector<Token> expected = Lexical::borrowed(source, options).tokenizeParallel(4);
+    Lexical expected_lexer = Lexical::borrowed(source, options);
+    expected_lexer.tokenizeParallel(4);
+    size_t expected_diagnostics = expected_lexer.getDiagnostics().size();
+    CHECK_EQ(expected_diagnostics, size_t{3});
+
+    Lexical lexer = Lexical::borrowed(source, options);
+    lexer.tokenize();
+    for (int run = 0; run < 2; ++run) {
+        std::vector<Token> tokens = lexer.tokenizeParallel(4);
+        CHECK_EQ(tokens.size(), expected.size());
+        CHECK_EQ(lexer.getDiagnostics().size(), expected_diagnostics);
+    }
+}
+
+/**
+ * 并行分析分配的符号 ID 与串行分析相同，块从字符串中间开始时推测出的标识符不会进入驻留表
+ */
+void testParallelSymbolsMatchSerial() {
+    std::string source;
+    for (size_t i = 0; i < 30000; ++i) {
+        source += "var name_" + std::to_string(i % 1000) + " = other\n";
+        if (i % 20 == 0) {
+            // 跨行字符串，块的边界落在其中时推测分析会把这些单词当成标识符
+            source += "val text = \"";
+            for (size_t line = 0; line < 10; ++line) {
+                source += "ghost_" + std::to_string(i * 10 + line) + "\n";
+            }
+            source += "\"\n";
+        }
+    }
+
+    for (TokenValueMode mode : {TokenValueMode::VIEW, TokenValueMode::OWNED}) {
+        SymbolTable serial_symbols;
+        SymbolTable parallel_symbols;
+        LexerOptions options;
+        options.value_mode = mode;
+        options.symbols = &serial_symbols;
+        std::vector<Token> serial = Lexical::borrowed(source, options).tokenize();
+        options.symbols = &parallel_symbols;
+        std::vector<Token> parallel = Lexical::borrowed(source, options).tokenizeParallel(8);
+
+        CHECK_EQ(parallel_symbols.size(), serial_symbols.size());
+        CHECK_EQ(parallel.size(), serial.size());
+        for (size_t i = 0; i < serial.size() && i < parallel.size(); ++i) {
+            CHECK_EQ(parallel[i].getSymbol(), serial[i].getSymbol());
+            CHECK_EQ(parallel[i].getValue(), serial[i].getValue());
+            if (serial[i].getType() == TokenType::IDENT) {
+                CHECK_EQ(parallel[i].ownsValue(), serial[i].ownsValue());
+            }
+        }
+    }
+}
+
+/**
+ * 驻留过的标识符按符号 ID 比较，其他Token按值比较
+ */
+void testTokenEqualityUsesSymbols() {
+    SymbolTable symbols;
+    LexerOptions options;
+    options.symbols = &symbols;
+    std::vector<Token> first = Lexical::borrowed("alpha beta alpha 1", options).tokenize();
+    std::vector<Token> second = Lexical::borrowed("alpha gamma", options).tokenize();
+
+    CHECK(first[0].hasSymbol());
+    CHECK(first[0] == first[2]);
+    CHECK(first[0] == second[0]);
+    CHECK(first[0] != first[1]);
+    CHECK(first[1] != second[1]);
+
+    // 没有驻留的一方按名字比较
+    Token plain(TokenType::IDENT, "alpha", 1);
+    CHECK(!plain.hasSymbol());
+    CHECK(plain == first[0]);
+    CHECK(Token(TokenType::IDENT, "beta", 1) == first[1]);
+    CHECK(plain != first[1]);
+    CHECK(first[3] == Token(TokenType::NUMBER, "1", 1));
+}
+
+/**
+ * 连续编辑后，两种容器的增量分析结果都与重新完整分析相同；
+ * 源码有时就地修改（缓冲区不变），有时换成新的字符串（VIEW Token需要重新指向）
+ */
+void testRetokenizeMatchesFullLex() {
+    std::string initial;
+    for (size_t i = 0; i < 4000; ++i) {
+        initial += "var item_" + std::to_string(i) + " = item_" + std::to_string(i / 2) + " + " + std::to_string(i) + "\n";
+        if (i % 50 == 0) {
+            initial += "val text = \"first\nsecond\"\n";
+        }
+    }
+    const char* lines[] = {"\n", "x = y * 2\n", "// note\n", "val s = \"a\nb\"\n", "fun f() { return 1.5e3 }\n"};
+
+    for (TokenValueMode mode : {TokenValueMode::VIEW, TokenValueMode::OWNED}) {
+        for (bool track : {true, false}) {
+            LexerOptions options;
+            options.value_mode = mode;
+            options.track_positions = track;
+            std::mt19937 rng(7);
+            std::string text = initial;
+            text.reserve(initial.size() * 2);
+            std::vector<Token> vector_tokens = Lexical::borrowed(text, options).tokenize();
+            SegmentedTokens segmented_tokens;
+            Lexical::borrowed(text, options).tokenizeInto(segmented_tokens);
+
+            for (int round = 0; round < 200; ++round) {
+                // 在行首插入一行，或删除不含引号的一整行
+                size_t offset = text.rfind('\n', rng() % text.size());
+                offset = offset == std::string::npos ? 0 : offset + 1;
+                size_t old_length = 0;
+                std::string inserted;
+                size_t line_end = text.find('\n', offset);
+                // 多行字符串的每一行都含引号，不含引号的行一定在字符串之外
+                if (rng() % 2 == 0 && line_end != std::string::npos && text.find('"', offset) > line_end) {
+                    old_length = line_end + 1 - offset;
+                } else {
+                    inserted = lines[rng() % std::size(lines)];
+                }
+                if (round % 3 == 0) {
+                    std::string moved = text;
+                    text.swap(moved);
+                }
+                text.replace(offset, old_length, inserted);
+                TextEdit edit{offset, old_length, inserted.size()};
+
+                Lexical lexer = Lexical::borrowed(text, options);
+                lexer.retokenize(vector_tokens, edit);
+                lexer.retokenize(segmented_tokens, edit);
+                std::vector<Token> expected = Lexical::borrowed(text, options).tokenize();
+
+                CHECK_EQ(vector_tokens.size(), expected.size());
+                CHECK_EQ(segmented_tokens.size(), expected.size());
+                bool same = vector_tokens.size() == expected.size() && segmented_tokens.size() == expected.size();
+                for (size_t i = 0; same && i < expected.size(); ++i) {
+                    const Token* actual_tokens[] = {&vector_tokens[i], &segmented_tokens[i]};
+                    for (const Token* actual : actual_tokens) {
+                        same = same && actual->getType() == expected[i].getType() &&
+                               actual->getValue() == expected[i].getValue() &&
+                               actual->getLine() == expected[i].getLine() &&
+                               actual->getOffset() == expected[i].getOffset();
+                    }
+                }
+                CHECK(same);
+                if (!same) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * 持有的值在内联存储和堆存储的分界两侧，拷贝、移动和赋值后都保持不变
+ */
+void testOwnedValuesSurviveCopies() {
+    for (size_t length : {size_t{0}, size_t{1}, size_t{16}, size_t{17}, size_t{200}}) {
+        std::string text(length, 'x');
+        if (length > 0) {
+            text.front() = 'a';
+            text.back() = 'z';
+        }
+        Token original(TokenType::STRING, text, 3, 7);
+        CHECK(original.ownsValue());
+        CHECK_EQ(original.getValue(), text);
+
+        Token copy = original;
+        CHECK_EQ(copy.getValue(), text);
+        CHECK(length == 0 || copy.getValue().data() != original.getValue().data());
+
+        Token assigned(TokenType::IDENT, std::string(40, 'q'), 1);
+        assigned = copy;
+        CHECK_EQ(assigned.getValue(), text);
+
+        Token moved = std::move(copy);
+        CHECK_EQ(moved.getValue(), text);
+        Token borrowed = Token::borrowed(TokenType::IDENT, "name", 1);
+        borrowed = std::move(moved);
+        CHECK_EQ(borrowed.getValue(), text);
+        CHECK_EQ(borrowed.getOffset(), size_t{7});
+        CHECK_EQ(original.getValue(), text);
+    }
+
+    // OWNED 模式下短值和长值都与 VIEW 模式的值相同
+    std::string source = "short \"a string literal well past sixteen bytes\" \"esc\\n\"\n";
+    LexerOptions options;
+    options.value_mode = TokenValueMode::VIEW;
+    std::vector<Token> view = Lexical::borrowed(source, options).tokenize();
+    options.value_mode = TokenValueMode::OWNED;
+    std::vector<Token> owned = Lexical::borrowed(source, options).tokenize();
+    CHECK_EQ(owned.size(), view.size());
+    for (size_t i = 0; i < view.size() && i < owned.size(); ++i) {
+        CHECK_EQ(owned[i].getValue(), view[i].getValue());
+    }
+}
+
+/**
+ * 工作线程按提交顺序执行自己队列中的任务，逐文件打印时结果可以边完成边输出
+ */
+void testThreadPoolRunsTasksInOrder() {
+    std::vector<int> order;
+    std::promise<void> all_submitted;
+    std::shared_future<void> submitted = all_submitted.get_future().share();
+    {
+        dreamlang::driver::ThreadPool pool(1);
+        // 第一个任务等到全部提交后才返回，其余任务此时都在队列中
+        pool.submit([&order, submitted] {
+            submitted.wait();
+            order.push_back(0);
+        });
+        for (int i = 1; i < 50; ++i) {
+            pool.submit([&order, i] { order.push_back(i); });
+        }
+        all_submitted.set_value();
+        pool.wait();
+    }
+    CHECK_EQ(order.size(), size_t{50});
+    for (size_t i = 0; i < order.size(); ++i) {
+        CHECK_EQ(order[i], static_cast<int>(i));
+    }
+}
+
+/**
+ * 把内容写入临时文件后用 TokenCacheReader 打开
+ */
+bool openCache(TokenCacheReader& reader, const std::string& content) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "dreamlang_lexer_test.dltok";
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+    bool opened = reader.open(path.string());
+    std::filesystem::remove(path);
+    return opened;
+}
+
+/**
+ * 缓存记录了词法分析结果的版本和选项：版本或选项不同、记录的类型或数字形式无效时都不能使用
+ */
+void testTokenCacheRejectsStaleFiles() {
+    std::string source = "var x = 0x10 + 2.5\nval s = \"a\\tb\"\n";
+    LexerOptions options;
+    options.value_mode = TokenValueMode::VIEW;
+    std::vector<Token> tokens = Lexical::borrowed(source, options).tokenize();
+    std::string content = encodeTokenCache(tokens, source, options);
+
+    TokenCacheReader reader;
+    CHECK(openCache(reader, content));
+    CHECK(reader.matches(source, options));
+    std::vector<Token> restored = reader.tokens(source);
+    CHECK_EQ(restored.size(), tokens.size());
+    for (size_t i = 0; i < tokens.size() && i < restored.size(); ++i) {
+        CHECK(restored[i] == tokens[i]);
+        CHECK_EQ(restored[i].getOffset(), tokens[i].getOffset());
+    }
+
+    // 行号模式或恢复模式不同的读取方不能使用这份缓存
+    LexerOptions untracked = options;
+    untracked.track_positions = false;
+    CHECK(!reader.matches(source, untracked));
+    LexerOptions recovering = options;
+    recovering.recover_errors = true;
+    CHECK(!reader.matches(source, recovering));
+    CHECK(!reader.matches(source + " ", options));
+
+    auto patched = [&content](size_t offset, const void* bytes, size_t size) {
+        std::string copy = content;
+        std::memcpy(&copy[offset], bytes, size);
+        return copy;
+    };
+    uint32_t stale_version = LEXER_OUTPUT_VERSION - 1;
+    CHECK(!openCache(reader, patched(offsetof(TokenCacheHeader, lexer_version), &stale_version, 4)));
+    uint8_t bad_type = static_cast<uint8_t>(TOKEN_TYPE_COUNT);
+    size_t last_record = sizeof(TokenCacheHeader) + (tokens.size() - 1) * sizeof(TokenRecord);
+    CHECK(!openCache(reader, patched(last_record + offsetof(TokenRecord, type), &bad_type, 1)));
+    uint8_t bad_form = static_cast<uint8_t>(NumberForm::FLOAT) + 1;
+    CHECK(!openCache(reader, patched(last_record + offsetof(TokenRecord, number_form), &bad_form, 1)));
+    CHECK(openCache(reader, content));
+}
+
+/**
+ * 表驱动后端与 switch 后端在非恢复和恢复模式下的Token、诊断和异常都相同
+ * 覆盖多字符操作符、进制前缀与溢出、源码中间的 '\0' 与真正的结尾、未结束的字符串和注释
+ */
+void testTableBackendMatchesSwitch() {
+    std::vector<std::string> sources = {
+        "a ** b * c *", "x && y || z", "a <= b < c >= d > e == f != g = !h", "a & b", "a | b", "&", "|", "a <", "a !",
+        "0x1F 0XfF 0b101 0B1 0o17 0O7", "0x", "0b", "0o", "0b2", "0o9", "0xg", "0x7FFFFFFFFFFFFFFF",
+        "0xFFFFFFFFFFFFFFFF", "0x10000000000000000", "0b" + std::string(63, '1'), "0b1" + std::string(63, '0'),
+        "0o777777777777777777777", "0o1000000000000000000000", "9223372036854775807", "9223372036854775808",
+        "1e 1.5e+ 1.5e-3 .5 5. 1e999 1e-999 12345678901234567890.5",
+        std::string("a\0b", 3), std::string("x = 1\0", 6), std::string("\"a\0b\"", 5), std::string("// c\0d\nx", 8),
+        std::string("/* \0 */ y", 9), std::string("'\0'", 3), std::string("\0", 1),
+        "\"abc", "\"abc\\", "\"a\\qb\" c", "'a", "'", "'ab' x", "/* abc", "/* abc *", "/* a */ b /", "x /",
+        "\"a\r\nb\" c\r\nd", "// only", "a // c\nb", "/**/ /***/ /* * / */", "'a' '\\n' '\\''", "@ # $ `", "\x80\xff",
+        "var s = \"one\ntwo\" + t\n/* x\ny */ z",
+    };
+    // 片段随机拼接，覆盖片段边界上的组合
+    const char* fragments[] = {"*", "**", "&", "&&", "|", "||", "<", "<=", "=", "!", "0x", "0b1", "0o7", "12",
+                               "1.5e", "ab", "\"", "\"s\"", "'", "/", "/*", "*/", "//", "\n", " ", "\\", ".", "9"};
+    std::mt19937 random(5);
+    for (int i = 0; i < 2000; ++i) {
+        std::string source;
+        for (int k = random() % 8; k >= 0; --k) {
+            source += fragments[random() % std::size(fragments)];
+        }
+        sources.push_back(source);
+    }
+
+    for (const std::string& source : sources) {
+        for (bool recover : {false, true}) {
+            LexerOptions options;
+            options.value_mode = TokenValueMode::VIEW;
+            options.recover_errors = recover;
+            LexOutcome expected = lexOutcome(source, options);
+            options.backend = LexerBackend::TABLE;
+            LexOutcome actual = lexOutcome(source, options);
+            if (!sameOutcome(actual, expected)) {
+                ++failures;
+                std::cerr << "table backend differs (recover=" << recover << "): " << printable(source) << "\n";
+            }
+        }
+    }
+}
+
+/**
+ * 分析只含一个数字字面量的源码（恢复模式），返回第一个Token和诊断信息
+ */
+LexResult lexNumber(const std::string& text, LexerBackend backend) {
+    LexerOptions options;
+    options.backend = backend;
+    options.recover_errors = true;
+    return Lexical::borrowed(text, options).tryTokenize();
+}
+
+/**
+ * 数字字面量在扫描时转换出的值：int64 的边界、各进制、快速路径的边界、from_chars 回退和下溢
+ */
+void testNumberValues() {
+    struct IntegerCase {
+        const char* text;
+        int64_t value;
+    };
+    const IntegerCase integers[] = {
+        {"0", 0},
+        {"00001", 1},
+        {"9223372036854775807", INT64_MAX},
+        {"0x7FFFFFFFFFFFFFFF", INT64_MAX},
+        {"0XfF", 255},
+        {"0b1010", 10},
+        {"0B111111111111111111111111111111111111111111111111111111111111111", INT64_MAX},
+        {"0o17", 15},
+        {"0O777777777777777777777", INT64_MAX},
+    };
+    // 超出 int64 的整数（包括 2^64 这种累加时会回绕的值）是 ILLEGAL Token
+    const char* out_of_range[] = {
+        "9223372036854775808", "18446744073709551616", "99999999999999999999", "0xFFFFFFFFFFFFFFFF",
+        "0x8000000000000000", "0b1000000000000000000000000000000000000000000000000000000000000000",
+        "0o1000000000000000000000", "1e309", "1.8e308", "1e999999999999",
+    };
+    // 浮点数与 strtod 的正确舍入结果逐位相同：
+    // 快速路径的边界（尾数 2^53、10 的 22 次幂）两侧、19 位以上有效数字的回退、次正规数和下溢
+    const char* floats[] = {
+        "1.5", "0.1", "0.3", "2.5e-3", "1e22", "1e23", "1e-22", "1e-23", "123456789e22", "123456789e-22",
+        "9007199254740992e0", "9007199254740993e0", "9007199254740992e22", "9007199254740993e-22",
+        "1234567890123456789e0", "12345678901234567890e0", "123456789012345678901e0", "0.12345678901234567890123",
+        "1.7976931348623157e308", "2.2250738585072014e-308", "4.9e-324", "1e-400", "123e-400", "1e-999999999999",
+        "0.0", "0e5",
+    };
+
+    for (LexerBackend backend : {LexerBackend::SWITCH, LexerBackend::TABLE}) {
+        for (const IntegerCase& integer : integers) {
+            LexResult result = lexNumber(integer.text, backend);
+            const Token& token = result.tokens[0];
+            CHECK(result.diagnostics.empty());
+            CHECK(token.getType() == TokenType::NUMBER && token.getNumberForm() == NumberForm::INTEGER);
+            CHECK_EQ(token.getInteger(), integer.value);
+        }
+        for (const char* text : out_of_range) {
+            LexResult result = lexNumber(text, backend);
+            CHECK(result.tokens[0].getType() == TokenType::ILLEGAL);
+            CHECK_EQ(result.tokens[0].getValue(), std::string_view(text));
+            CHECK(result.diagnostics.size() == 1 && result.diagnostics[0].code == LexicalErrorCode::NUMBER_OUT_OF_RANGE);
+        }
+        for (const char* text : floats) {
+            LexResult result = lexNumber(text, backend);
+            const Token& token = result.tokens[0];
+            CHECK(result.diagnostics.empty());
+            CHECK(token.getType() == TokenType::NUMBER && token.getNumberForm() == NumberForm::FLOAT);
+            double expected = std::strtod(text, nullptr);
+            if (token.getFloat() != expected) {
+                ++failures;
+                std::cerr << "float " << text << " lexed as " << token.getFloat() << ", expected " << expected << "\n";
+            }
+        }
+
+        // 随机的尾数和指数，覆盖快速路径内外
+        std::mt19937_64 random(16);
+        for (int i = 0; i < 3000; ++i) {
+            uint64_t mantissa = random() >> (random() % 64);
+            int exponent = static_cast<int>(random() % 80) - 40;
+            std::string text = std::to_string(mantissa) + "e" + std::to_string(exponent);
+            LexResult result = lexNumber(text, backend);
+            double expected = std::strtod(text.c_str(), nullptr);
+            if (result.tokens[0].getNumberForm() != NumberForm::FLOAT || result.tokens[0].getFloat() != expected) {
+                ++failures;
+                std::cerr << "float " << text << " lexed as " << result.tokens[0].getFloat() << ", expected "
+                          << expected << "\n";
+            }
+        }
+    }
+}
+
+/**
+ * 行内的随机编辑：插入或删除引号、注释符号、反斜杠，从中间切开Token，
+ * 使字符串和多行注释在编辑后打开或闭合；恢复模式下两种容器的结果都与重新完整分析相同
+ */
+void testRetokenizeSubLineEdits() {
+    std::string initial;
+    for (size_t i = 0; i < 600; ++i) {
+        initial += "val name_" + std::to_string(i) + " = \"text " + std::to_string(i) + "\" + 0x1F ** 2 // note\n";
+        if (i % 40 == 0) {
+            initial += "/* block\ncomment */ x && y || 'c'\n";
+        }
+    }
+    const char* inserts[] = {"\"", "/*", "*/", "\\", "'", "\n", " ", "x", "12", "*", "/", ""};
+
+    for (TokenValueMode mode : {TokenValueMode::VIEW, TokenValueMode::OWNED}) {
+        LexerOptions options;
+        options.value_mode = mode;
+        options.recover_errors = true;
+        std::mt19937 random(11);
+        std::string text = initial;
+        std::vector<Token> vector_tokens = Lexical::borrowed(text, options).tokenize();
+        SegmentedTokens segmented_tokens;
+        Lexical::borrowed(text, options).tokenizeInto(segmented_tokens);
+
+        for (int round = 0; round < 300; ++round) {
+            size_t offset = random() % (text.size() + 1);
+            size_t old_length = std::min<size_t>(random() % 4, text.size() - offset);
+            std::string inserted = inserts[random() % std::size(inserts)];
+            text.replace(offset, old_length, inserted);
+            TextEdit edit{offset, old_length, inserted.size()};
+
+            Lexical lexer = Lexical::borrowed(text, options);
+            lexer.retokenize(vector_tokens, edit);
+            lexer.retokenize(segmented_tokens, edit);
+            std::vector<Token> expected = Lexical::borrowed(text, options).tokenize();
+
+            bool same = sameTokens(vector_tokens, expected) && segmented_tokens.size() == expected.size();
+            for (size_t i = 0; same && i < expected.size(); ++i) {
+                same = sameToken(segmented_tokens[i], expected[i]);
+            }
+            if (!same) {
+                ++failures;
+                std::cerr << "retokenize differs after edit " << round << " at offset " << offset << " ("
+                          << old_length << " -> " << printable(inserted) << ")\n";
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * 通过管道流式分析源码，结果整理为与 lexOutcome 相同的形式
+ * 写端在另一个线程中写入，读端每次 read(2) 最多读 block_size 个字节
+ */
+LexOutcome streamOutcome(const std::string& source, const LexerOptions& options, size_t block_size) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        std::perror("pipe");
+        std::exit(1);
+    }
+    std::thread writer([&source, fd = fds[1]] {
+        for (size_t written = 0; written < source.size();) {
+            ssize_t n = write(fd, source.data() + written, source.size() - written);
+            if (n <= 0) {
+                break;
+            }
+            written += static_cast<size_t>(n);
+        }
+        close(fd);
+    });
+
+    LexOutcome outcome;
+    StreamLexer lexer(fds[0], options, block_size);
+    try {
+        // StreamLexer 的 VIEW Token只在下一次调用前有效，拷贝为持有值的Token再保存
+        while (outcome.tokens.empty() || outcome.tokens.back().getType() != TokenType::EOF_TOKEN) {
+            Token token = lexer.nextToken();
+            outcome.tokens.push_back(token);
+        }
+    } catch (const LexicalException& e) {
+        // tokenize() 出错时不返回任何Token，已交出的Token不参与比较
+        outcome.tokens.clear();
+        outcome.threw = true;
+        outcome.error_type = e.getErrorType();
+        outcome.error_line = e.getLine();
+        outcome.error_column = e.getColumn();
+        outcome.error_char = e.getErrorChar();
+    }
+    outcome.diagnostics = lexer.getDiagnostics();
+
+    // 出错时读端可能没读完，先读空管道让写端结束
+    char rest[4096];
+    while (read(fds[0], rest, sizeof(rest)) > 0) {
+    }
+    writer.join();
+    close(fds[0]);
+    return outcome;
+}
+
+/**
+ * 字符串、注释、转义和多字符运算符跨过读取块边界时，流式分析与整体分析结果相同
+ */
+void testStreamLexerMatchesTokenize() {
+    const std::string valid = "var s = \"esc\\\"aped \\\\ \\n str\" ** 2 && b || c <= d >= e != f == g\n"
+                              "/* block\n comment ** && */ x // line ** comment\r\n"
+                              "1.5e10 0x1F 0b101 0o17 .5 1e+5 12345678901234567890.5 9223372036854775807\n"
+                              "'c' '\\n' \"multi\nline\" \"\" a**b&&c||d<=e\n"
+                              "\xE5\x90\x8D = \"\xE4\xB8\xAD\xE6\x96\x87\" /**/ /***/ y\n";
+    const std::vector<std::string> sources = {
+        valid,
+        valid + "a & b | c\n\"bad \\q escape\" 0x 0b2 1e 9223372036854775808 @ # $\n'ab' '\n/* never closed",
+        valid + "\"unterminated\n" + valid,
+        std::string("x\0y ** z", 8),
+        "",
+        "/* only a comment */",
+        "a**",
+    };
+
+    for (const std::string& source : sources) {
+        for (LexerBackend backend : {LexerBackend::SWITCH, LexerBackend::TABLE}) {
+            for (size_t max_errors : {size_t{0}, size_t{2}}) {
+                for (bool recover : {false, true}) {
+                    LexerOptions options;
+                    options.backend = backend;
+                    options.recover_errors = recover;
+                    options.max_errors = max_errors;
+                    LexOutcome expected = lexOutcome(source, options);
+                    for (size_t block_size : {1, 2, 3, 5, 7, 16, 4096}) {
+                        LexOutcome actual = streamOutcome(source, options, block_size);
+                        if (!sameOutcome(actual, expected)) {
+                            ++failures;
+                            std::cerr << "stream lexer differs (block_size=" << block_size << ", recover=" << recover
+                                      << ", max_errors=" << max_errors << "): " << printable(source.substr(0, 80))
+                                      << "\n";
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * scan() 的结果整理为与 lexOutcome 相同的形式，另外返回统计结果
+ */
+LexOutcome scanOutcome(const std::string& source, const LexerOptions& options, ScanSummary& summary) {
+    LexOutcome outcome;
+    Lexical lexer = Lexical::borrowed(source, options);
+    try {
+        summary = lexer.scan();
+    } catch (const LexicalException& e) {
+        outcome.threw = true;
+        outcome.error_type = e.getErrorType();
+        outcome.error_line = e.getLine();
+        outcome.error_column = e.getColumn();
+        outcome.error_char = e.getErrorChar();
+    }
+    outcome.diagnostics = lexer.getDiagnostics();
+    return outcome;
+}
+
+/**
+ * scan() 与 tokenize() 接受的语言、统计的Token数和报告的错误相同（--count 和 --check 依赖这一点）
+ */
+void testScanMatchesTokenize() {
+    std::vector<std::string> sources = {
+        "var s = \"esc\\\"aped\" ** 2 && b || c <= d\n/* c\n */ x // y\r\n1.5e10 0x1F 0b101 0o17 'c' '\\n'\n",
+        "a & b | c\n\"bad \\q escape\" 0x 0b2 0o9 1e 9223372036854775808 1e999 @ # $\n'ab' '\n\"open\n/* never closed",
+        std::string("x\0y ** z", 8), "", "\n\n", "/* only */", "\"abc", "'", "a ! b != c", "\x80\xff",
+    };
+    const char* fragments[] = {"*", "**", "&", "&&", "|", "||", "<=", "=", "!", "0x", "0b1", "0o7", "12", "1.5e",
+                               "ab", "\"", "\"s\\t\"", "'", "'\\q'", "/", "/*", "*/", "//", "\n", " ", "\\", "."};
+    std::mt19937 random(24);
+    for (int i = 0; i < 1000; ++i) {
+        std::string source;
+        for (int k = random() % 10; k >= 0; --k) {
+            source += fragments[random() % std::size(fragments)];
+        }
+        sources.push_back(source);
+    }
+
+    for (const std::string& source : sources) {
+        for (LexerBackend backend : {LexerBackend::SWITCH, LexerBackend::TABLE}) {
+            for (size_t max_errors : {size_t{0}, size_t{1}, size_t{3}}) {
+                for (bool recover : {false, true}) {
+                    LexerOptions options;
+                    options.value_mode = TokenValueMode::VIEW;
+                    options.backend = backend;
+                    options.recover_errors = recover;
+                    options.max_errors = max_errors;
+                    LexOutcome expected = lexOutcome(source, options);
+                    ScanSummary summary;
+                    LexOutcome actual = scanOutcome(source, options, summary);
+
+                    std::array<size_t, TOKEN_TYPE_COUNT> counts{};
+                    for (const Token& token : expected.tokens) {
+                        ++counts[static_cast<size_t>(token.getType())];
+                    }
+                    // scan() 不产生Token，只比较错误和诊断信息，Token数和各类型的数量单独比较
+                    actual.tokens = expected.tokens;
+                    if (!sameOutcome(actual, expected) || (!expected.threw && summary.tokens != expected.tokens.size()) ||
+                        (!expected.threw && summary.counts != counts)) {
+                        ++failures;
+                        std::cerr << "scan differs (recover=" << recover << ", max_errors=" << max_errors
+                                  << "): " << printable(source.substr(0, 80)) << "\n";
+                    }
+                }
+            }
+        }
+    }
+}
+
+const dreamlang::test::TestCase TESTS[] = {
+    {"token lines match lazy lines", testTokenLinesMatchLazyLines},
+    {"parallel tokenization starts fresh", testParallelStartsFresh},
+    {"parallel symbol IDs match serial", testParallelSymbolsMatchSerial},
+    {"token equality uses symbol IDs", testTokenEqualityUsesSymbols},
+    {"retokenize matches a full lex", testRetokenizeMatchesFullLex},
+    {"retokenize handles sub-line edits", testRetokenizeSubLineEdits},
+    {"owned values survive copies", testOwnedValuesSurviveCopies},
+    {"thread pool runs tasks in order", testThreadPoolRunsTasksInOrder},
+    {"token cache rejects stale files", testTokenCacheRejectsStaleFiles},
+    {"table backend matches switch", testTableBackendMatchesSwitch},
+    {"number literal values", testNumberValues},
+    {"stream lexer matches tokenize across blocks", testStreamLexerMatchesTokenize},
+    {"scan matches tokenize", testScanMatchesTokenize},
+};
+
+} // namespace
+
+int main() {
+    return dreamlang::test::runTests(TESTS);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+
+// 测试共用的检查宏和运行器
+// 每个测试是一个函数，检查失败时输出位置并继续运行，全部运行后以失败数决定退出码
+
+namespace dreamlang::test {
+
+inline int failures = 0;
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+/**
+ * 依次运行全部测试并输出每个测试的结果
+ * @return 进程退出码，有失败的检查时为 1
+ */
+template <size_t N>
+int runTests(const TestCase (&tests)[N]) {
+    for (const TestCase& test : tests) {
+        int before = failures;
+        test.run();
+        std::cout << (failures == before ? "[ OK ] " : "[FAIL] ") << test.name << "\n";
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace dreamlang::test
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) {                                                               \
+            ++dreamlang::test::failures;                                                  \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed\n"; \
+        }                                                                                 \
+    } while (false)
+
+#define CHECK_EQ(actual, expected)                                                                \
+    do {                                                                                          \
+        auto actual_value = (actual);                                                             \
+        auto expected_value = (expected);                                                         \
+        if (!(actual_value == expected_value)) {                                                  \
+            ++dreamlang::test::failures;                                                          \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #actual ", " #expected ") failed: " \
+                      << actual_value << " != " << expected_value << "\n";                        \
+        }                                                                                         \
+    } while (false)
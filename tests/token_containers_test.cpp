@@ -0,0 +1,243 @@
+#include "lexer/lexical.h"
+#include "lexer/token_buffer.h"
+#include "lexer/token_cursor.h"
+#include "test_support.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 列式Token缓冲区和Token游标的测试
+
+namespace {
+
+using namespace dreamlang::lexer;
+
+/**
+ * 生成多行源码：转义和不含转义的字符串、字符交替出现，夹有空行和字符串中的 CRLF，
+ * 使解码池中有足够多的条目，value() 要在 decoded_index_ 中做真正的二分查找
+ */
+std::string containerSource() {
+    std::string source;
+    for (int i = 0; i < 40; ++i) {
+        source += "var s" + std::to_string(i) + " = ";
+        switch (i % 4) {
+        case 0:
+            source += "\"tab\\there " + std::to_string(i) + "\"\n";
+            break;
+        case 1:
+            source += "\"plain " + std::to_string(i) + "\" + '\\n'\n\n";
+            break;
+        case 2:
+            source += "\"crlf\r\nin string\\\\\" + 'x'\r\n";
+            break;
+        default:
+            source += "\"quote \\\"" + std::to_string(i) + "\\\"\" ** 2 // comment\n";
+            break;
+        }
+    }
+    return source;
+}
+
+LexerOptions viewOptions() {
+    LexerOptions options;
+    options.value_mode = TokenValueMode::VIEW;
+    return options;
+}
+
+void testTokenBufferMatchesTokenize() {
+    std::string source = containerSource();
+    std::vector<Token> tokens = Lexical::borrowed(source, viewOptions()).tokenize();
+
+    TokenBuffer buffer;
+    Lexical lexer = Lexical::borrowed(source, viewOptions());
+    lexer.tokenizeInto(buffer);
+    CHECK_EQ(buffer.size(), tokens.size());
+    if (buffer.size() != tokens.size()) {
+        return;
+    }
+
+    size_t decoded = 0;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        CHECK(buffer.type(i) == tokens[i].getType());
+        CHECK_EQ(buffer.value(i), tokens[i].getValue());
+        CHECK_EQ(buffer.line(i), tokens[i].getLine());
+
+        // 偏移和长度总是指向源码中的原文，解码字面量的原文是引号之间未解码的文本
+        std::string_view raw = source.substr(buffer.offset(i), buffer.length(i));
+        bool literal = tokens[i].getType() == TokenType::STRING || tokens[i].getType() == TokenType::CHAR;
+        if (literal && raw != tokens[i].getValue()) {
+            ++decoded;
+            CHECK(raw.find('\\') != std::string_view::npos);
+            CHECK_EQ(source[buffer.offset(i) - 1], tokens[i].getType() == TokenType::STRING ? '"' : '\'');
+        } else {
+            CHECK_EQ(raw, tokens[i].getValue());
+        }
+    }
+    CHECK(decoded >= 20);
+
+    // 迭代器视图与下标访问一致
+    size_t index = 0;
+    for (TokenBuffer::View view : buffer) {
+        CHECK_EQ(view.index(), index);
+        CHECK_EQ(view.getValue(), buffer.value(index));
+        CHECK_EQ(view.getLine(), buffer.line(index));
+        ++index;
+    }
+    CHECK_EQ(index, buffer.size());
+
+    TokenBuffer::Iterator it = buffer.begin();
+    CHECK_EQ(buffer.end() - it, static_cast<std::ptrdiff_t>(buffer.size()));
+    it += 17;
+    CHECK_EQ((*it).getValue(), tokens[17].getValue());
+    CHECK_EQ(it[5].getValue(), tokens[22].getValue());
+    CHECK_EQ((*(it - 3)).index(), 14u);
+    CHECK(buffer.begin() < it && it <= buffer.end());
+    CHECK((*(buffer.end() - 1)).getType() == TokenType::EOF_TOKEN);
+
+    auto strings = std::count_if(buffer.begin(), buffer.end(),
+                                 [](TokenBuffer::View view) { return view.getType() == TokenType::STRING; });
+    auto expected = std::count_if(tokens.begin(), tokens.end(),
+                                  [](const Token& token) { return token.getType() == TokenType::STRING; });
+    CHECK_EQ(strings, expected);
+    CHECK_EQ(std::count(buffer.types().begin(), buffer.types().end(), static_cast<uint8_t>(TokenType::STRING)),
+             expected);
+
+    // 再次填充时清空原有内容，包括行号游程和解码池
+    std::string other = "\"a\\tb\"\n\n'c'";
+    Lexical other_lexer = Lexical::borrowed(other, viewOptions());
+    other_lexer.tokenizeInto(buffer);
+    std::vector<Token> other_tokens = Lexical::borrowed(other, viewOptions()).tokenize();
+    CHECK_EQ(buffer.size(), other_tokens.size());
+    for (size_t i = 0; i < std::min(buffer.size(), other_tokens.size()); ++i) {
+        CHECK(buffer.type(i) == other_tokens[i].getType());
+        CHECK_EQ(buffer.value(i), other_tokens[i].getValue());
+        CHECK_EQ(buffer.line(i), other_tokens[i].getLine());
+    }
+    CHECK_EQ(buffer.source(), std::string_view(other));
+}
+
+/**
+ * 游标返回的Token与 tokenize() 的第 index 个Token相同
+ */
+bool sameAt(const Token& token, const std::vector<Token>& tokens, size_t index) {
+    const Token& expected = tokens[std::min(index, tokens.size() - 1)];
+    return token.getType() == expected.getType() && token.getValue() == expected.getValue() &&
+           token.getLine() == expected.getLine();
+}
+
+void testTokenCursorPeekBeyondCapacity() {
+    std::string source = containerSource();
+    std::vector<Token> tokens = Lexical::borrowed(source, viewOptions()).tokenize();
+    Lexical lexer = Lexical::borrowed(source, viewOptions());
+    TokenCursor cursor(lexer, 3);
+    CHECK_EQ(cursor.capacity(), 4u);
+
+    // 向前查看超过容量时缓冲区扩大，当前位置不变
+    CHECK(sameAt(cursor.peek(10), tokens, 10));
+    CHECK(cursor.capacity() >= 11);
+    CHECK_EQ(cursor.position(), 0u);
+    for (size_t i = 0; i <= 10; ++i) {
+        CHECK(sameAt(cursor.next(), tokens, i));
+    }
+
+    // EOF 之后的位置都是EOF Token，next() 停在EOF上
+    CHECK(cursor.peek(tokens.size() * 2).getType() == TokenType::EOF_TOKEN);
+    while (cursor.position() + 1 < tokens.size()) {
+        size_t position = cursor.position();
+        CHECK(sameAt(cursor.next(), tokens, position));
+    }
+    for (int i = 0; i < 3; ++i) {
+        CHECK(cursor.next().getType() == TokenType::EOF_TOKEN);
+    }
+    CHECK_EQ(cursor.position(), tokens.size() - 1);
+}
+
+void testTokenCursorRewindAcrossWrap() {
+    std::string source = containerSource();
+    std::vector<Token> tokens = Lexical::borrowed(source, viewOptions()).tokenize();
+    Lexical lexer = Lexical::borrowed(source, viewOptions());
+    TokenCursor cursor(lexer, 4);
+
+    // 不持有标记时逐个读取，环形缓冲区绕回多圈而不扩大
+    for (size_t i = 0; i < 30; ++i) {
+        CHECK(sameAt(cursor.next(), tokens, i));
+    }
+    CHECK_EQ(cursor.capacity(), 4u);
+
+    // 标记之后读过的Token跨过缓冲区末尾，回溯后再读结果相同
+    TokenCursor::Mark mark = cursor.mark();
+    CHECK_EQ(mark, 30u);
+    for (size_t i = 30; i < 33; ++i) {
+        CHECK(sameAt(cursor.next(), tokens, i));
+    }
+    cursor.rewind(mark);
+    CHECK_EQ(cursor.position(), 30u);
+    for (size_t i = 30; i < 33; ++i) {
+        CHECK(sameAt(cursor.next(), tokens, i));
+    }
+    CHECK_EQ(cursor.capacity(), 4u);
+
+    // 持有标记时读过的Token都要保留，缓冲区扩大；标记仍然有效，可以再次回溯
+    for (size_t i = 33; i < 50; ++i) {
+        CHECK(sameAt(cursor.next(), tokens, i));
+    }
+    size_t grown = cursor.capacity();
+    CHECK(grown >= 20);
+    cursor.rewind(mark);
+    for (size_t i = 30; i < 50; ++i) {
+        CHECK(sameAt(cursor.next(), tokens, i));
+    }
+
+    // 释放后旧Token可以被覆盖，继续读取不再扩大
+    cursor.release(mark);
+    for (size_t i = 50; i < 50 + grown * 3 && i + 1 < tokens.size(); ++i) {
+        CHECK(sameAt(cursor.next(), tokens, i));
+    }
+    CHECK_EQ(cursor.capacity(), grown);
+}
+
+void testTokenCursorNestedMarks() {
+    std::string source = containerSource();
+    std::vector<Token> tokens = Lexical::borrowed(source, viewOptions()).tokenize();
+    Lexical lexer = Lexical::borrowed(source, viewOptions());
+    TokenCursor cursor(lexer, 2);
+
+    for (size_t i = 0; i < 5; ++i) {
+        cursor.next();
+    }
+    // 释放内层标记后外层标记仍然保护它之后的Token
+    TokenCursor::Mark outer = cursor.mark();
+    for (size_t i = 5; i < 9; ++i) {
+        cursor.next();
+    }
+    TokenCursor::Mark inner = cursor.mark();
+    for (size_t i = 9; i < 20; ++i) {
+        cursor.next();
+    }
+    cursor.rewind(inner);
+    CHECK(sameAt(cursor.next(), tokens, 9));
+    cursor.release(inner);
+    for (size_t i = 10; i < 30; ++i) {
+        cursor.next();
+    }
+    cursor.rewind(outer);
+    for (size_t i = 5; i < 30; ++i) {
+        CHECK(sameAt(cursor.next(), tokens, i));
+    }
+    cursor.release(outer);
+}
+
+const dreamlang::test::TestCase TESTS[] = {
+    {"token buffer matches tokenize", testTokenBufferMatchesTokenize},
+    {"token cursor peeks beyond its capacity", testTokenCursorPeekBeyondCapacity},
+    {"token cursor rewinds across ring wrap-around", testTokenCursorRewindAcrossWrap},
+    {"token cursor keeps tokens for outer marks", testTokenCursorNestedMarks},
+};
+
+} // namespace
+
+int main() {
+    return dreamlang::test::runTests(TESTS);
+}
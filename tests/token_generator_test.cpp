@@ -0,0 +1,106 @@
+#include "lexer/lexical.h"
+#include "lexer/lexical_exception.h"
+#include "lexer/token_generator.h"
+#include "test_support.h"
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <version>
+
+// C++20 接口的测试：协程生成器和 Lexical 的惰性范围，以 C++20 编译
+
+#if DREAMLANG_HAS_COROUTINES && defined(__cpp_lib_ranges)
+
+#include <ranges>
+
+namespace {
+
+using namespace dreamlang::lexer;
+
+static_assert(std::ranges::input_range<Lexical&>);
+static_assert(std::ranges::input_range<TokenGenerator&>);
+
+const std::string SOURCE = "var a = b ** 2 && \"text\"\n// comment\nc = d || e\nstop f g\nh";
+
+bool isIdentifier(const Token& token) { return token.getType() == TokenType::IDENT; }
+
+bool beforeStop(const Token& token) { return token.getValue() != "stop"; }
+
+void testGeneratorMatchesTokenize() {
+    std::vector<Token> tokens = Lexical(SOURCE).tokenize();
+    Lexical lexer(SOURCE);
+    size_t index = 0;
+    for (const Token& token : generateTokens(lexer)) {
+        CHECK(index < tokens.size() && token == tokens[index]);
+        ++index;
+    }
+    // 生成器不产生EOF Token
+    CHECK_EQ(index + 1, tokens.size());
+}
+
+/**
+ * 在惰性范围上组合 filter 和 take_while，提前停止后剩余的源码没有被分析
+ */
+template <typename Range>
+void checkLazyView(Lexical& lexer, Range&& range) {
+    std::vector<std::string> names;
+    for (const Token& token : range | std::views::filter(isIdentifier) | std::views::take_while(beforeStop)) {
+        names.emplace_back(token.getValue());
+    }
+    CHECK(names == std::vector<std::string>({"a", "b", "c", "d", "e"}));
+
+    // take_while 在 stop 处停止，词法分析器停在它之后
+    Token next = lexer.nextToken();
+    CHECK_EQ(next.getValue(), std::string_view("f"));
+}
+
+void testLazyRanges() {
+    {
+        Lexical lexer(SOURCE);
+        TokenGenerator generator = generateTokens(lexer);
+        checkLazyView(lexer, generator);
+    }
+    {
+        Lexical lexer(SOURCE);
+        checkLazyView(lexer, lexer);
+    }
+}
+
+void testGeneratorRethrowsErrors() {
+    Lexical lexer("a b & c");
+    std::vector<std::string> names;
+    bool threw = false;
+    try {
+        for (const Token& token : generateTokens(lexer)) {
+            names.emplace_back(token.getValue());
+        }
+    } catch (const LexicalException&) {
+        threw = true;
+    }
+    // 错误之前的Token照常产生，错误在使用者自增迭代器时抛出
+    CHECK(threw);
+    CHECK(names == std::vector<std::string>({"a", "b"}));
+}
+
+const dreamlang::test::TestCase TESTS[] = {
+    {"generator matches tokenize", testGeneratorMatchesTokenize},
+    {"filter and take_while over lazy ranges", testLazyRanges},
+    {"generator rethrows lexical errors", testGeneratorRethrowsErrors},
+};
+
+} // namespace
+
+int main() {
+    return dreamlang::test::runTests(TESTS);
+}
+
+#else
+
+// 编译器不支持协程或标准库没有范围库时跳过（ctest 按 SKIP_RETURN_CODE 记为跳过）
+int main() {
+    std::cout << "C++20 coroutines or ranges are not available, skipped\n";
+    return 77;
+}
+
+#endif
@@ -0,0 +1,279 @@
+#include "lexer/token.h"
+#include "lexer/token_serialize.h"
+#include "test_support.h"
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 序列化输出的测试，与固定的字节串比较
+
+namespace {
+
+using namespace dreamlang::lexer;
+
+/**
+ * 把字节列表拼成字符串
+ */
+std::string bytes(std::initializer_list<int> values) {
+    std::string result;
+    for (int value : values) {
+        result.push_back(static_cast<char>(value));
+    }
+    return result;
+}
+
+/**
+ * 以转义形式打印字节串，便于比较失败时查看
+ */
+std::string printable(const std::string& text) {
+    static const char HEX[] = "0123456789abcdef";
+    std::string result;
+    for (unsigned char c : text) {
+        if (c >= 0x20 && c < 0x7F && c != '\\') {
+            result.push_back(static_cast<char>(c));
+        } else {
+            result += "\\x";
+            result.push_back(HEX[c >> 4]);
+            result.push_back(HEX[c & 0xF]);
+        }
+    }
+    return result;
+}
+
+#define CHECK_BYTES(actual, expected) CHECK_EQ(printable(actual), printable(expected))
+
+std::vector<Token> single(TokenType type, const std::string& value, int line = 1) {
+    return {Token(type, value, line)};
+}
+
+std::string json(const std::string& value) {
+    return serialize(single(TokenType::STRING, value), "json", SerializeStyle::COMPACT);
+}
+
+std::string jsonDocument(const std::string& escaped) {
+    return "[{\"line\":1,\"type\":\"STRING\",\"value\":\"" + escaped + "\"}]";
+}
+
+void testJsonEscapes() {
+    CHECK_BYTES(json("quote\" back\\slash"), jsonDocument("quote\\\" back\\\\slash"));
+    CHECK_BYTES(json("\b\f\n\r\t"), jsonDocument("\\b\\f\\n\\r\\t"));
+    CHECK_BYTES(json(bytes({0x00, 0x01, 0x1F, 0x7F})), jsonDocument("\\u0000\\u0001\\u001f\\u007f"));
+
+    // 合法的多字节序列原样输出
+    CHECK_BYTES(json("\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80"), jsonDocument("\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80"));
+
+    // 非法的 UTF-8 每个字节替换为 U+FFFD：孤立的续字节、截断的序列、过长编码、代理项、超出 U+10FFFF
+    CHECK_BYTES(json(bytes({'a', 0x80, 'b'})), jsonDocument("a\\ufffdb"));
+    CHECK_BYTES(json(bytes({0xC3})), jsonDocument("\\ufffd"));
+    CHECK_BYTES(json(bytes({0xE4, 0xB8, 'x'})), jsonDocument("\\ufffd\\ufffdx"));
+    CHECK_BYTES(json(bytes({0xC0, 0xAF})), jsonDocument("\\ufffd\\ufffd"));
+    CHECK_BYTES(json(bytes({0xED, 0xA0, 0x80})), jsonDocument("\\ufffd\\ufffd\\ufffd"));
+    CHECK_BYTES(json(bytes({0xF4, 0x90, 0x80, 0x80})), jsonDocument("\\ufffd\\ufffd\\ufffd\\ufffd"));
+    CHECK_BYTES(json(bytes({0xFF})), jsonDocument("\\ufffd"));
+
+    CHECK_BYTES(serialize({}, "json"), "[]");
+    CHECK_BYTES(serialize(single(TokenType::STRING, "a\n"), "json", SerializeStyle::PRETTY),
+                "[\n    {\n        \"line\": 1,\n        \"type\": \"STRING\",\n        \"value\": \"a\\n\"\n    }\n]");
+}
+
+std::string toml(const std::string& value, SerializeStyle style) {
+    return serialize(single(TokenType::STRING, value), "toml", style);
+}
+
+std::string tomlDocument(const std::string& value) {
+    return "[[tokens]]\nline = 1\ntype = 'STRING'\nvalue = " + value;
+}
+
+std::string tomlInline(const std::string& value) {
+    return "tokens = [\n{ line = 1, type = 'STRING', value = " + value + " },\n]";
+}
+
+void testTomlStrings() {
+    // 不需要转义时使用字面量字符串，制表符可以直接出现在字面量字符串中
+    CHECK_BYTES(toml("plain \\ text", SerializeStyle::PRETTY), tomlDocument("'plain \\ text'"));
+    CHECK_BYTES(toml("tab\there", SerializeStyle::PRETTY), tomlDocument("'tab\there'"));
+    CHECK_BYTES(toml("\xC3\xA9", SerializeStyle::PRETTY), tomlDocument("'\xC3\xA9'"));
+    CHECK_BYTES(toml("", SerializeStyle::PRETTY), tomlDocument("''"));
+
+    // 含换行时使用多行字面量字符串，开头定界符后补的换行会被解析器去掉
+    CHECK_BYTES(toml("a\nb", SerializeStyle::PRETTY), tomlDocument("'''\na\nb'''"));
+    CHECK_BYTES(toml("\nlead", SerializeStyle::PRETTY), tomlDocument("'''\n\nlead'''"));
+
+    // 内联表中不能换行，退回基本字符串
+    CHECK_BYTES(toml("a\nb", SerializeStyle::COMPACT), tomlInline("\"a\\nb\""));
+    CHECK_BYTES(toml("plain", SerializeStyle::COMPACT), tomlInline("'plain'"));
+
+    // 单引号、其他控制字符和非法 UTF-8 无法放进字面量字符串
+    CHECK_BYTES(toml("it's", SerializeStyle::PRETTY), tomlDocument("\"it's\""));
+    CHECK_BYTES(toml("it's\nmulti", SerializeStyle::PRETTY), tomlDocument("\"it's\\nmulti\""));
+    CHECK_BYTES(toml("cr\r\n", SerializeStyle::PRETTY), tomlDocument("\"cr\\r\\n\""));
+    CHECK_BYTES(toml(bytes({'d', 'e', 'l', 0x7F}), SerializeStyle::PRETTY), tomlDocument("\"del\\u007f\""));
+    CHECK_BYTES(toml(bytes({'x', 0xFF}), SerializeStyle::PRETTY), tomlDocument("\"x\\ufffd\""));
+
+    CHECK_BYTES(serialize({}, "toml"), "tokens = []");
+    std::vector<Token> two = {Token(TokenType::STRING, "a", 1), Token(TokenType::STRING, "b", 2)};
+    CHECK_BYTES(serialize(two, "toml"),
+                "[[tokens]]\nline = 1\ntype = 'STRING'\nvalue = 'a'\n\n[[tokens]]\nline = 2\ntype = 'STRING'\nvalue = 'b'");
+}
+
+/**
+ * 同一个值在 MessagePack 和 CBOR 中的编码
+ */
+struct WidthCase {
+    size_t value;
+    std::string msgpack;
+    std::string cbor;
+};
+
+// 行号使用的无符号整数
+const WidthCase UNSIGNED_CASES[] = {
+    {15, bytes({0x0F}), bytes({0x0F})},
+    {23, bytes({0x17}), bytes({0x17})},
+    {24, bytes({0x18}), bytes({0x18, 0x18})},
+    {127, bytes({0x7F}), bytes({0x18, 0x7F})},
+    {128, bytes({0xCC, 0x80}), bytes({0x18, 0x80})},
+    {255, bytes({0xCC, 0xFF}), bytes({0x18, 0xFF})},
+    {256, bytes({0xCD, 0x01, 0x00}), bytes({0x19, 0x01, 0x00})},
+    {65535, bytes({0xCD, 0xFF, 0xFF}), bytes({0x19, 0xFF, 0xFF})},
+    {65536, bytes({0xCE, 0x00, 0x01, 0x00, 0x00}), bytes({0x1A, 0x00, 0x01, 0x00, 0x00})},
+};
+
+// Token数组的长度，MessagePack 的数组没有 8 位长度的形式
+const WidthCase ARRAY_CASES[] = {
+    {15, bytes({0x9F}), bytes({0x8F})},
+    {16, bytes({0xDC, 0x00, 0x10}), bytes({0x90})},
+    {23, bytes({0xDC, 0x00, 0x17}), bytes({0x97})},
+    {24, bytes({0xDC, 0x00, 0x18}), bytes({0x98, 0x18})},
+    {255, bytes({0xDC, 0x00, 0xFF}), bytes({0x98, 0xFF})},
+    {256, bytes({0xDC, 0x01, 0x00}), bytes({0x99, 0x01, 0x00})},
+    {65535, bytes({0xDC, 0xFF, 0xFF}), bytes({0x99, 0xFF, 0xFF})},
+    {65536, bytes({0xDD, 0x00, 0x01, 0x00, 0x00}), bytes({0x9A, 0x00, 0x01, 0x00, 0x00})},
+};
+
+// 合法 UTF-8 的值写为字符串
+const WidthCase STRING_CASES[] = {
+    {0, bytes({0xA0}), bytes({0x60})},
+    {15, bytes({0xAF}), bytes({0x6F})},
+    {16, bytes({0xB0}), bytes({0x70})},
+    {23, bytes({0xB7}), bytes({0x77})},
+    {24, bytes({0xB8}), bytes({0x78, 0x18})},
+    {31, bytes({0xBF}), bytes({0x78, 0x1F})},
+    {32, bytes({0xD9, 0x20}), bytes({0x78, 0x20})},
+    {255, bytes({0xD9, 0xFF}), bytes({0x78, 0xFF})},
+    {256, bytes({0xDA, 0x01, 0x00}), bytes({0x79, 0x01, 0x00})},
+    {65535, bytes({0xDA, 0xFF, 0xFF}), bytes({0x79, 0xFF, 0xFF})},
+    {65536, bytes({0xDB, 0x00, 0x01, 0x00, 0x00}), bytes({0x7A, 0x00, 0x01, 0x00, 0x00})},
+};
+
+// 非法 UTF-8 的值写为二进制数据，MessagePack 的 bin 没有更短的固定长度形式
+const WidthCase BINARY_CASES[] = {
+    {1, bytes({0xC4, 0x01}), bytes({0x41})},
+    {23, bytes({0xC4, 0x17}), bytes({0x57})},
+    {24, bytes({0xC4, 0x18}), bytes({0x58, 0x18})},
+    {255, bytes({0xC4, 0xFF}), bytes({0x58, 0xFF})},
+    {256, bytes({0xC5, 0x01, 0x00}), bytes({0x59, 0x01, 0x00})},
+    {65535, bytes({0xC5, 0xFF, 0xFF}), bytes({0x59, 0xFF, 0xFF})},
+    {65536, bytes({0xC6, 0x00, 0x01, 0x00, 0x00}), bytes({0x5A, 0x00, 0x01, 0x00, 0x00})},
+};
+
+/**
+ * 二进制格式的一种编码：文档开头、"types" 键、单元素的Token数组和单个Token数组的开头
+ */
+struct BinaryFormat {
+    const char* name;
+    std::string WidthCase::*encoding;
+    std::string document_head;
+    std::string types_key;
+    std::string one_token;
+    std::string tuple_head;
+    std::string x_value;
+};
+
+const BinaryFormat BINARY_FORMATS[] = {
+    {"msgpack", &WidthCase::msgpack, bytes({0x82, 0xA6}) + "tokens", bytes({0xA5}) + "types", bytes({0x91}),
+     bytes({0x93}), bytes({0xA1}) + "x"},
+    {"cbor", &WidthCase::cbor, bytes({0xA2, 0x66}) + "tokens", bytes({0x65}) + "types", bytes({0x81}),
+     bytes({0x83}), bytes({0x61}) + "x"},
+};
+
+// 第 1 行和 IDENT 的类型编码，在两种格式中都是单字节的正整数
+const std::string LINE_ONE = bytes({0x01});
+const std::string IDENT_CODE = bytes({static_cast<int>(TokenType::IDENT)});
+
+/**
+ * 检查 output 以 expected 开头，并且紧接着是 "types" 键
+ * 只打印开头的 printed 个字节，避免大文档比较失败时输出过多
+ */
+void checkDocument(const std::string& output, const std::string& expected, const BinaryFormat& format,
+                   size_t printed) {
+    printed = std::min(printed, expected.size());
+    CHECK_BYTES(output.substr(0, printed), expected.substr(0, printed));
+    CHECK(output.compare(0, expected.size(), expected) == 0);
+    CHECK(output.compare(expected.size(), format.types_key.size(), format.types_key) == 0);
+}
+
+void testBinaryWidths() {
+    for (const BinaryFormat& format : BINARY_FORMATS) {
+        for (const WidthCase& line : UNSIGNED_CASES) {
+            std::string expected = format.document_head + format.one_token + format.tuple_head +
+                                   line.*format.encoding + IDENT_CODE + format.x_value;
+            checkDocument(serialize(single(TokenType::IDENT, "x", static_cast<int>(line.value)), format.name),
+                          expected, format, expected.size());
+        }
+
+        std::string tuple = format.tuple_head + LINE_ONE + IDENT_CODE + format.x_value;
+        for (const WidthCase& count : ARRAY_CASES) {
+            std::vector<Token> tokens(count.value, Token(TokenType::IDENT, "x", 1));
+            std::string expected = format.document_head + count.*format.encoding;
+            for (size_t i = 0; i < count.value; ++i) {
+                expected += tuple;
+            }
+            checkDocument(serialize(tokens, format.name), expected, format,
+                          format.document_head.size() + (count.*format.encoding).size() + tuple.size());
+        }
+
+        for (const WidthCase& length : STRING_CASES) {
+            std::string value(length.value, 'a');
+            std::string head = format.document_head + format.one_token + format.tuple_head + LINE_ONE + IDENT_CODE +
+                               length.*format.encoding;
+            checkDocument(serialize(single(TokenType::IDENT, value), format.name), head + value, format,
+                          head.size() + 1);
+        }
+
+        for (const WidthCase& length : BINARY_CASES) {
+            std::string value = bytes({0xFF}) + std::string(length.value - 1, 'a');
+            std::string head = format.document_head + format.one_token + format.tuple_head + LINE_ONE + IDENT_CODE +
+                               length.*format.encoding;
+            checkDocument(serialize(single(TokenType::IDENT, value), format.name), head + value, format,
+                          head.size() + 1);
+        }
+    }
+}
+
+void testBinaryTypeNames() {
+    // 空文档：空的Token数组，之后是全部类型名
+    std::string msgpack = bytes({0x82, 0xA6}) + "tokens" + bytes({0x90, 0xA5}) + "types" +
+                          bytes({0xDC, 0x00, static_cast<int>(TOKEN_TYPE_COUNT), 0xA7}) + "ILLEGAL";
+    std::string cbor = bytes({0xA2, 0x66}) + "tokens" + bytes({0x80, 0x65}) + "types" +
+                       bytes({0x98, static_cast<int>(TOKEN_TYPE_COUNT), 0x67}) + "ILLEGAL";
+    CHECK_BYTES(serialize({}, "msgpack").substr(0, msgpack.size()), msgpack);
+    CHECK_BYTES(serialize({}, "cbor").substr(0, cbor.size()), cbor);
+    // 上面按类型数在 24 到 255 之间写出了数组长度的编码
+    CHECK(TOKEN_TYPE_COUNT >= 24 && TOKEN_TYPE_COUNT <= 255);
+}
+
+const dreamlang::test::TestCase TESTS[] = {
+    {"json escapes control characters and invalid UTF-8", testJsonEscapes},
+    {"toml chooses literal or basic strings", testTomlStrings},
+    {"msgpack and cbor choose the shortest widths", testBinaryWidths},
+    {"msgpack and cbor list the type names", testBinaryTypeNames},
+};
+
+} // namespace
+
+int main() {
+    return dreamlang::test::runTests(TESTS);
+}